@@ -12,46 +12,20 @@
  *===========================================================================*/
 osThreadId isr_id;
  
-void PIOINT2_IRQHandler(void)
+// Called from PIOINT2_IRQHandler (gpio.c) for the pin that fired
+void joystick_irq(uint32_t port, uint32_t pin, void *arg)
 {
-    if (!GPIOGetValue(PORT2, 0))
-      printf("Joystick center\n");
-    
-    if (!GPIOGetValue(PORT2, 1))
-      printf("Joystick down\n");
-    
-    if (!GPIOGetValue(PORT2, 2))
-      printf("Joystick right\n");
-    
-    if (!GPIOGetValue(PORT2, 3))
-      printf("Joystick up\n");
-    
-    if (!GPIOGetValue(PORT2, 4))
-      printf("Joystick left\n");
- 
-   osSignalSet(isr_id, 0x1);
-    
-    GPIOIntClear(2, 0);
-    GPIOIntClear(2, 1);
-    GPIOIntClear(2, 2);
-    GPIOIntClear(2, 3);
-    GPIOIntClear(2, 4);
+    LOG1("Joystick %s\n", arg);
+    osSignalSet(isr_id, 0x1);
 }
 
-
 void setup_isr()
 {
-    setup_port(PORT2, 0, 0, 1, 1);
-    setup_port(PORT2, 1, 0, 1, 1);
-    setup_port(PORT2, 2, 0, 1, 1);
-    setup_port(PORT2, 3, 0, 1, 1);
-    setup_port(PORT2, 4, 0, 1, 1);
-    
-    GPIOIntEnable(PORT2, 0); // JOYSTICK_CENTER
-    GPIOIntEnable(PORT2, 1); // JOYSTICK_DOWN
-    GPIOIntEnable(PORT2, 2); // JOYSTICK_RIGHT
-    GPIOIntEnable(PORT2, 3); // JOYSTICK_UP
-    GPIOIntEnable(PORT2, 4); // JOYSTICK_LEFT
+    GPIOAttachIrq(PORT2, 0, GPIO_EDGE_FALLING, joystick_irq, "center");
+    GPIOAttachIrq(PORT2, 1, GPIO_EDGE_FALLING, joystick_irq, "down");
+    GPIOAttachIrq(PORT2, 2, GPIO_EDGE_FALLING, joystick_irq, "right");
+    GPIOAttachIrq(PORT2, 3, GPIO_EDGE_FALLING, joystick_irq, "up");
+    GPIOAttachIrq(PORT2, 4, GPIO_EDGE_FALLING, joystick_irq, "left");
 }
  
 void led_thread(void const *args) {
@@ -79,6 +53,7 @@ int main (void) {
       joystick_init();
       setup_isr();
       I2CInit( (uint32_t)I2CMASTER, 0 );
+      LOGInit(&log_terminal);
 
       osThreadCreate(osThread(led_thread), NULL);
       isr_id = osThreadCreate(osThread(isr_thread), NULL);
@@ -41,10 +41,8 @@ void receive_thread (void const *args) {
         osEvent evt = osMailGet(mail_box, osWaitForever);
         if (evt.status == osEventMail) {
             mail_t *mail = (mail_t*)evt.value.p;
-            printf("\nTemperature: %i \n\r", mail->temp);
-            printf("Light: %u \n\r" , mail->light);
-            printf("Trimpot: %u \n\r" , mail->trimpot);
-            printf("Number of messages: %u\n\r", mail->counter);
+            LOG4("\nTemperature: %i \n\rLight: %u \n\rTrimpot: %u \n\rNumber of messages: %u\n\r",
+                 mail->temp, mail->light, mail->trimpot, mail->counter);
             
             osMailFree(mail_box, mail);
         }
@@ -61,6 +59,7 @@ int main (void) {
     light_init();
     acc_init();
     temp_init (&getTicks);
+    LOGInit(&log_terminal);
    
     mail_box = osMailCreate(osMailQ(mail_box), NULL);
   
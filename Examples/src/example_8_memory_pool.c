@@ -44,10 +44,8 @@ void receive_thread (void const *args) {
         osEvent evt = osMessageGet(queue, osWaitForever);
         if (evt.status == osEventMessage) {
             message_t *message = (message_t*)evt.value.p;
-            printf("\nTemperature: %i \n\r", message->temp);
-            printf("Light: %u \n\r"     , message->light);
-            printf("Trimpot: %u \n\r"     , message->trimpot);
-            printf("Number of messages: %u\n\r", message->counter);
+            LOG4("\nTemperature: %i \n\rLight: %u \n\rTrimpot: %u \n\rNumber of messages: %u\n\r",
+                 message->temp, message->light, message->trimpot, message->counter);
             
             osPoolFree(mpool, message);
         }
@@ -66,6 +64,7 @@ int main (void) {
     light_init();
     acc_init();
     temp_init (&getTicks);
+    LOGInit(&log_terminal);
    
     mpool = osPoolCreate(osPool(mpool));
     queue = osMessageCreate(osMessageQ(queue), NULL);
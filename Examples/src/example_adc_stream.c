@@ -0,0 +1,85 @@
+#include "libdemo.h"
+/*============================================================================
+ *                  Exemplos de utilizao do RTOS CMSIS
+ *           LPCXpresso 1343 + Embedded Artists Development Board 
+ *---------------------------------------------------------------------------*
+ *          Amostragem do ADC disparada por timer e medida de jitter
+ *---------------------------------------------------------------------------*
+ *                    Prof. Andr Schneider de Oliveira
+ *            Universidade Tecnolgica Federal do Paran (UTFPR)
+ *===========================================================================
+ * Obs: Abra a janela Terminal I/O no Debugger - Menu View/Terminal I/O
+ *===========================================================================*/
+
+#define SAMPLE_RATE     1000            /* trimpot samples per second     */
+#define HALF_SAMPLES    100             /* 100 ms of samples per buffer   */
+#define POLL_PERIOD     10              /* osDelay based reference, ms    */
+
+static uint16_t samples[2 * HALF_SAMPLES];
+static ADCJitter poll_jitter;
+
+void print_jitter(const char *name, ADCJitter *j)
+{
+    uint32_t i;
+
+    LOG4("%s: %u intervals, min %u max %u cycles\n",
+         name, j->count, j->min, j->max);
+    for (i = 0; i < ADC_JITTER_BINS; i += 4) {
+        LOG4("  %6u %6u %6u %6u\n",
+             j->hist[i], j->hist[i + 1], j->hist[i + 2], j->hist[i + 3]);
+    }
+}
+
+// Hardware timed: CT16B0 MAT0 starts every conversion
+void stream_thread(void const *args) {
+    uint32_t halves = 0;
+    uint32_t rate;
+    ADCJitter j;
+
+    rate = ADCStreamStart(samples, HALF_SAMPLES, 0x01, SAMPLE_RATE,
+                          ADC_TRIG_CT16B0_MAT0, osThreadGetId(), 0x1);
+    LOG1("Trimpot stream at %u Hz\n", rate);
+
+    while (1) {
+        osSignalWait(0x1, osWaitForever);
+        uint16_t *half = ADCStreamGetBuffer();
+        if (half == NULL)
+            continue;
+
+        uint32_t sum = 0;
+        for (int i = 0; i < HALF_SAMPLES; i++)
+            sum += half[i];
+
+        if (++halves % 10 == 0) {
+            LOG2("Trimpot avg %u, overruns %u\n",
+                 sum / HALF_SAMPLES, ADCStreamGetOverrun());
+            ADCStreamGetJitter(&j);
+            print_jitter("match trigger", &j);
+            print_jitter("osDelay", &poll_jitter);
+        }
+    }
+}
+osThreadDef(stream_thread, osPriorityHigh, 1, 0);
+
+// Reference: the wake up times of a thread sleeping with osDelay
+void poll_thread(void const *args) {
+    ADCJitterInit(&poll_jitter, (SystemCoreClock / 1000) * POLL_PERIOD);
+    while (1) {
+        osDelay(POLL_PERIOD);
+        ADCJitterAdd(&poll_jitter, DWT->CYCCNT);
+    }
+}
+osThreadDef(poll_thread, osPriorityNormal, 1, 0);
+
+int main (void) {
+    osKernelInitialize();
+
+    ADCInit( ADC_CLK );
+    LOGInit(&log_terminal);
+
+    osThreadCreate(osThread(stream_thread), NULL);
+    osThreadCreate(osThread(poll_thread), NULL);
+
+    osKernelStart();
+    osDelay(osWaitForever);
+}
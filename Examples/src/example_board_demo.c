@@ -117,6 +117,8 @@ int main (void)
     acc_init();
     led7seg_init();
     rgb_init();
+    /* polled measurement: TEMP_USE_CAPTURE in temp.c would take over
+       timer32 0, which this demo uses for delay32Ms */
     temp_init (&getTicks);
 
     /* setup sys Tick. Elapsed time is e.g. needed by temperature sensor */
@@ -0,0 +1,91 @@
+#include "libdemo.h"
+/*============================================================================
+ *                  Exemplos de utilizao do RTOS CMSIS
+ *           LPCXpresso 1343 + Embedded Artists Development Board 
+ *---------------------------------------------------------------------------*
+ *                    Escrita na EEPROM com polling de ACK
+ *---------------------------------------------------------------------------*
+ *                    Prof. Andr Schneider de Oliveira
+ *            Universidade Tecnolgica Federal do Paran (UTFPR)
+ *===========================================================================
+ * Obs: Abra a janela Terminal I/O no Debugger - Menu View/Terminal I/O
+ *===========================================================================*/
+
+#define EEPROM_SIZE     1024
+#define PATTERNS        2
+
+static uint8_t data[EEPROM_SIZE];
+static uint8_t check[EEPROM_SIZE];
+
+static void fill(uint8_t seed)
+{
+    for (int i = 0; i < EEPROM_SIZE; i++)
+        data[i] = (uint8_t)(i * 7 + seed);
+}
+
+static uint32_t verify(void)
+{
+    uint32_t errors = 0;
+
+    eeprom_read(check, 0, EEPROM_SIZE);
+    for (int i = 0; i < EEPROM_SIZE; i++) {
+        if (check[i] != data[i])
+            errors++;
+    }
+    return errors;
+}
+
+static void report(const char *name, uint32_t cycles, uint32_t polls)
+{
+    uint32_t us = cycles / (SystemCoreClock / 1000000);
+
+    LOG4("%-12s %7u us, %5u bytes/s, %u polls\n", name, us,
+         (uint32_t)((uint64_t)EEPROM_SIZE * 1000000 / us), polls);
+}
+
+// Reescrita completa da EEPROM, bloqueante e em segundo plano
+void bench_thread(void const *args) {
+    uint32_t start, cycles, polls, idle;
+
+    fill(0);
+    polls = eeprom_getPollCount();
+    start = cycles_now();
+    eeprom_write(data, 0, EEPROM_SIZE);
+    cycles = cycles_now() - start;
+    report("blocking", cycles, eeprom_getPollCount() - polls);
+    LOG1("verify: %u errors\n", verify());
+
+    // while the pages are written this thread keeps counting
+    fill(0x55);
+    idle = 0;
+    polls = eeprom_getPollCount();
+    start = cycles_now();
+    eeprom_writeAsync(data, 0, EEPROM_SIZE, osThreadGetId(), 0x1);
+    while (eeprom_writeBusy()) {
+        idle++;
+        osThreadYield();
+    }
+    osSignalWait(0x1, osWaitForever);
+    cycles = cycles_now() - start;
+    report("async", cycles, eeprom_getPollCount() - polls);
+    LOG2("result %d, %u loops in the caller\n", eeprom_writeResult(), idle);
+    LOG1("verify: %u errors\n", verify());
+
+    osThreadTerminate(osThreadGetId());
+}
+osThreadDef(bench_thread, osPriorityBelowNormal, 1, 0);
+
+int main (void) {
+    osKernelInitialize();
+
+    I2CInit( (uint32_t)I2CMASTER, 0 );
+    USTimerInit();      // ACK polling sleeps between probes
+    eeprom_init();
+    cycles_init();
+    LOGInit(&log_terminal);
+
+    osThreadCreate(osThread(bench_thread), NULL);
+
+    osKernelStart();
+    osDelay(osWaitForever);
+}
@@ -0,0 +1,71 @@
+#include "libdemo.h"
+/*============================================================================
+ *                  Exemplos de utilizao do RTOS CMSIS
+ *           LPCXpresso 1343 + Embedded Artists Development Board 
+ *---------------------------------------------------------------------------*
+ *                   Desempenho do acesso aos pinos de GPIO
+ *---------------------------------------------------------------------------*
+ *                    Prof. Andr Schneider de Oliveira
+ *            Universidade Tecnolgica Federal do Paran (UTFPR)
+ *===========================================================================
+ * Obs: Abra a janela Terminal I/O no Debugger - Menu View/Terminal I/O
+ *===========================================================================*/
+
+#define TOGGLES     1000
+
+// P0.7 drives LED2 on the LPCXpresso board
+#define BENCH_PORT  PORT0
+#define BENCH_BIT   7
+
+void report(const char *name, uint32_t cycles)
+{
+    printf("%-22s %5u cycles, %3u.%02u cycles/toggle\n", name, cycles,
+           cycles / TOGGLES, (cycles % TOGGLES) / (TOGGLES / 100));
+}
+
+int main (void) {
+    uint32_t start, i;
+    gpio_pin_t led = GPIO_PIN(BENCH_PORT, BENCH_BIT);
+
+    GPIOInit();
+    GPIOSetDir(BENCH_PORT, BENCH_BIT, 1);
+    cycles_init();
+
+    __disable_irq();
+
+    start = cycles_now();
+    for (i = 0; i < TOGGLES / 2; i++) {
+        GPIOSetValue(BENCH_PORT, BENCH_BIT, 1);
+        GPIOSetValue(BENCH_PORT, BENCH_BIT, 0);
+    }
+    uint32_t set_value = cycles_now() - start;
+
+    start = cycles_now();
+    for (i = 0; i < TOGGLES / 2; i++) {
+        GPIOPinSet(led);
+        GPIOPinClear(led);
+    }
+    uint32_t masked = cycles_now() - start;
+
+    start = cycles_now();
+    for (i = 0; i < TOGGLES; i++) {
+        GPIOPinToggle(led);
+    }
+    uint32_t toggle = cycles_now() - start;
+
+    start = cycles_now();
+    for (i = 0; i < TOGGLES; i++) {
+        __NOP();
+    }
+    uint32_t loop = cycles_now() - start;
+
+    __enable_irq();
+
+    printf("GPIO toggle benchmark, %u toggles (loop overhead %u cycles)\n",
+           TOGGLES, loop);
+    report("GPIOSetValue", set_value);
+    report("GPIOPinSet/Clear", masked);
+    report("GPIOPinToggle", toggle);
+
+    while (1);
+}
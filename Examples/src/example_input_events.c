@@ -0,0 +1,70 @@
+#include "libdemo.h"
+/*============================================================================
+ *                  Exemplos de utilizao do RTOS CMSIS
+ *           LPCXpresso 1343 + Embedded Artists Development Board 
+ *---------------------------------------------------------------------------*
+ *              Eventos do joystick e do rotary por interrupcao
+ *---------------------------------------------------------------------------*
+ *                    Prof. Andr Schneider de Oliveira
+ *            Universidade Tecnolgica Federal do Paran (UTFPR)
+ *===========================================================================
+ * Obs: Abra a janela Terminal I/O no Debugger - Menu View/Terminal I/O
+ *===========================================================================*/
+
+// Nomes dos bits JOYSTICK_xxx, do CENTER (0x01) ao RIGHT (0x10)
+static const char *direction[] = { "center", "up", "down", "left", "right" };
+
+static const char *joystickName(uint8_t code)
+{
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        if (code == (1 << i))
+            return direction[i];
+    }
+    return "?";
+}
+
+// Tempo em ms para marcar os eventos (recomeca a cada 2^32 ciclos, ~60 s)
+static uint32_t getMs(void)
+{
+    return osKernelSysTick() / (osKernelSysTickFrequency / 1000);
+}
+
+// Consome a fila de eventos: joystick com debounce e passos do rotary
+void input_thread(void const *args) {
+    input_event_t ev;
+    int32_t position = 0;
+
+    input_init(getMs, 0);
+    while (1) {
+        if (!input_getEvent(&ev, 5000)) {
+            printf("idle, %u events dropped\n", input_getDropped());
+            continue;
+        }
+        switch (ev.type) {
+        case INPUT_JOYSTICK_PRESS:
+            printf("%8u ms  %s pressed\n", ev.time, joystickName(ev.code));
+            break;
+        case INPUT_JOYSTICK_RELEASE:
+            printf("%8u ms  %s released\n", ev.time, joystickName(ev.code));
+            break;
+        case INPUT_ROTARY:
+            position += (ev.code == ROTARY_RIGHT) ? 1 : -1;
+            printf("%8u ms  rotary %d\n", ev.time, position);
+            break;
+        }
+    }
+}
+osThreadDef(input_thread, osPriorityNormal, 1, 0);
+
+int main (void) {
+    osKernelInitialize();
+
+    GPIOInit();
+
+    osThreadCreate(osThread(input_thread), NULL);
+
+    osKernelStart();
+    osDelay(osWaitForever);
+}
@@ -0,0 +1,209 @@
+#include "libdemo.h"
+/*============================================================================
+ *                  Exemplos de utilizao do RTOS CMSIS
+ *           LPCXpresso 1343 + Embedded Artists Development Board 
+ *---------------------------------------------------------------------------*
+ *                   Desempenho do desenho no display OLED
+ *---------------------------------------------------------------------------*
+ *                    Prof. Andr Schneider de Oliveira
+ *            Universidade Tecnolgica Federal do Paran (UTFPR)
+ *===========================================================================
+ * Obs: Abra a janela Terminal I/O no Debugger - Menu View/Terminal I/O
+ *===========================================================================*/
+
+#define FRAMES      20
+#define PRIMS       50
+#define ICONS       200
+
+// Icone 16x16 (aviso), duas paginas de bytes de coluna
+static const uint8_t icon[] = {
+    0x00, 0x00, 0x00, 0x80, 0xE0, 0x38, 0x0E, 0xE3,
+    0xE3, 0x0E, 0x38, 0xE0, 0x80, 0x00, 0x00, 0x00,
+    0xE0, 0xF8, 0xCE, 0xC3, 0xC0, 0xC0, 0xC0, 0xDB,
+    0xDB, 0xC0, 0xC0, 0xC0, 0xC3, 0xCE, 0xF8, 0xE0,
+};
+
+// Tela de exemplo: moldura, textos e barras com os valores dos sensores
+static void dashboard(uint32_t n)
+{
+    uint8_t text[16];
+
+    oled_clearScreen(OLED_COLOR_WHITE);
+    oled_rect(0, 0, OLED_DISPLAY_WIDTH - 1, OLED_DISPLAY_HEIGHT - 1,
+              OLED_COLOR_BLACK);
+    oled_line(0, 12, OLED_DISPLAY_WIDTH - 1, 12, OLED_COLOR_BLACK);
+    oled_putString(4, 3, (uint8_t *)"Dashboard", OLED_COLOR_BLACK,
+                   OLED_COLOR_WHITE);
+
+    sprintf((char *)text, "Temp %3u", 200 + n % 50);
+    oled_putString(4, 16, text, OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+    sprintf((char *)text, "Lux  %3u", (n * 37) % 1000);
+    oled_putString(4, 26, text, OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+    sprintf((char *)text, "Pot  %3u", (n * 13) % 1024);
+    oled_putString(4, 36, text, OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+
+    oled_fillRect(4, 48, 4 + n % 80, 56, OLED_COLOR_BLACK);
+    oled_circle(80, 30, 8, OLED_COLOR_BLACK);
+}
+
+// Implementacao anterior, pixel a pixel, como referencia
+static void ref_fillRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
+                         oled_color_t color)
+{
+    for (uint8_t y = y0; y <= y1; y++)
+        for (uint8_t x = x0; x <= x1; x++)
+            oled_putPixel(x, y, color);
+}
+
+// Desenho do icone pixel a pixel, como referencia
+static void ref_blit(uint8_t x, uint8_t y)
+{
+    for (uint8_t r = 0; r < 16; r++)
+        for (uint8_t c = 0; c < 16; c++)
+            oled_putPixel(x + c, y + r, (oled_color_t)
+                          ((icon[(r >> 3) * 16 + c] >> (r & 7)) & 1));
+}
+
+static void icons(const char *name, uint32_t cycles)
+{
+    printf("%-10s %6u icons/s\n", name, SystemCoreClock / (cycles / ICONS));
+}
+
+static void primitives(const char *name, uint32_t ref, uint32_t span)
+{
+    printf("%-10s %6u/s per pixel, %6u/s spans\n", name,
+           SystemCoreClock / (ref / PRIMS), SystemCoreClock / (span / PRIMS));
+}
+
+static void report(const char *name, uint32_t cycles)
+{
+    uint32_t us = cycles / (SystemCoreClock / 1000000) / FRAMES;
+
+    printf("%-10s %6u us/frame, %3u.%u fps\n", name, us,
+           1000000 / us, (10000000 / us) % 10);
+}
+
+int main (void) {
+    uint32_t start, i;
+    SSPStats init;
+
+    osKernelInitialize();
+    GPIOInit();
+    SSPInit();
+    SSPResetStats();
+    oled_init();
+    SSPGetStats(SSP_CLIENT_OLED, &init);
+    cycles_init();
+
+    // tela inteira apagada, enviada diretamente
+    start = cycles_now();
+    for (i = 0; i < FRAMES; i++)
+        oled_clearScreen(i & 1 ? OLED_COLOR_WHITE : OLED_COLOR_BLACK);
+    uint32_t clear = cycles_now() - start;
+
+    start = cycles_now();
+    for (i = 0; i < FRAMES; i++)
+        dashboard(i);
+    uint32_t immediate = cycles_now() - start;
+
+    oled_setRetained(TRUE);
+    start = cycles_now();
+    for (i = 0; i < FRAMES; i++) {
+        dashboard(i);
+        oled_flush();
+    }
+    uint32_t retained = cycles_now() - start;
+
+    // somente o desenho do texto no framebuffer
+    start = cycles_now();
+    for (i = 0; i < FRAMES; i++)
+        oled_putString(0, i % 56, (uint8_t *)"0123456789ABCDEF",
+                       OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+    uint32_t text = cycles_now() - start;
+    oled_flush();
+
+    // fonte compactada de 16 pixels, posicoes alinhadas e deslocadas
+    start = cycles_now();
+    for (i = 0; i < FRAMES; i++)
+        oled_putText(0, i % 48, (uint8_t *)"-1234.5", &font_digits16,
+                     OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+    uint32_t digits = cycles_now() - start;
+    oled_flush();
+
+    // primitivas somente no framebuffer: por pixel x por spans
+    start = cycles_now();
+    for (i = 0; i < PRIMS; i++)
+        ref_fillRect(0, i % 8, 95, i % 8, OLED_COLOR_BLACK);
+    uint32_t ref_hline = cycles_now() - start;
+    start = cycles_now();
+    for (i = 0; i < PRIMS; i++)
+        oled_line(0, i % 8, 95, i % 8, OLED_COLOR_BLACK);
+    uint32_t hline = cycles_now() - start;
+
+    start = cycles_now();
+    for (i = 0; i < PRIMS; i++)
+        ref_fillRect(i % 8, 0, i % 8, 63, OLED_COLOR_BLACK);
+    uint32_t ref_vline = cycles_now() - start;
+    start = cycles_now();
+    for (i = 0; i < PRIMS; i++)
+        oled_line(i % 8, 0, i % 8, 63, OLED_COLOR_BLACK);
+    uint32_t vline = cycles_now() - start;
+
+    start = cycles_now();
+    for (i = 0; i < PRIMS; i++)
+        ref_fillRect(10, 5 + i % 3, 70, 50, OLED_COLOR_BLACK);
+    uint32_t ref_fill = cycles_now() - start;
+    start = cycles_now();
+    for (i = 0; i < PRIMS; i++)
+        oled_fillRect(10, 5 + i % 3, 70, 50, OLED_COLOR_BLACK);
+    uint32_t fill = cycles_now() - start;
+    oled_flush();
+
+    // icones 16x16 somente no framebuffer
+    start = cycles_now();
+    for (i = 0; i < ICONS; i++)
+        ref_blit((i * 16) % 80, (i % 6) * 8);
+    uint32_t ref_icon = cycles_now() - start;
+    start = cycles_now();
+    for (i = 0; i < ICONS; i++)
+        oled_blit((i * 16) % 80, (i % 6) * 8, 16, 16, icon, OLED_ROP_COPY);
+    uint32_t icon_aligned = cycles_now() - start;
+    start = cycles_now();
+    for (i = 0; i < ICONS; i++)
+        oled_blit((i * 16) % 80, (i % 6) * 8 + 3, 16, 16, icon, OLED_ROP_COPY);
+    uint32_t icon_shifted = cycles_now() - start;
+    start = cycles_now();
+    for (i = 0; i < ICONS; i++)
+        oled_blit((i * 16) % 80, (i % 6) * 8 + 3, 16, 16, icon, OLED_ROP_XOR);
+    uint32_t icon_xor = cycles_now() - start;
+    oled_flush();
+
+    // buffer duplo: o envio fica com a thread de flush, aqui so o desenho
+    osKernelStart();
+    oled_setDoubleBuffered(TRUE);
+    start = cycles_now();
+    for (i = 0; i < FRAMES; i++) {
+        dashboard(i);
+        oled_swap();
+    }
+    uint32_t swapped = cycles_now() - start;
+    oled_flush();
+
+    printf("init       %6u CS, %u bytes\n", init.selects, init.bytes);
+    report("clear", clear);
+    printf("OLED dashboard redraw, %u frames\n", FRAMES);
+    report("immediate", immediate);
+    report("retained", retained);
+    report("double", swapped);
+    printf("text       %6u cycles/char\n", text / (FRAMES * 16));
+    printf("digits16   %6u cycles/char\n", digits / (FRAMES * 7));
+    primitives("hline", ref_hline, hline);
+    primitives("vline", ref_vline, vline);
+    primitives("fillRect", ref_fill, fill);
+    icons("icon pixel", ref_icon);
+    icons("icon y%8=0", icon_aligned);
+    icons("icon y%8=3", icon_shifted);
+    icons("icon xor", icon_xor);
+
+    osDelay(osWaitForever);
+}
@@ -0,0 +1,72 @@
+#include "libdemo.h"
+/*============================================================================
+ *                  Exemplos de utilizao do RTOS CMSIS
+ *           LPCXpresso 1343 + Embedded Artists Development Board 
+ *---------------------------------------------------------------------------*
+ *                  Contadores de transacoes SPI por driver
+ *---------------------------------------------------------------------------*
+ *                    Prof. Andr Schneider de Oliveira
+ *            Universidade Tecnolgica Federal do Paran (UTFPR)
+ *===========================================================================
+ * Obs: Abra a janela Terminal I/O no Debugger - Menu View/Terminal I/O
+ *===========================================================================*/
+
+#define LOOPS       20
+
+// Maior transferencia observada pelo hook, por cliente
+static uint32_t worst[SSP_CLIENTS];
+
+static void profile(uint32_t client, uint32_t bytes, uint32_t cycles)
+{
+    if (cycles > worst[client])
+        worst[client] = cycles;
+}
+
+static void report(const char *name, uint32_t client)
+{
+    SSPStats s;
+
+    SSPGetStats(client, &s);
+    if (s.selects == 0)
+        return;
+    printf("%-6s %5u CS %5u xfers %6u bytes %4u bytes/CS %5u us max\n",
+           name, s.selects, s.transfers, s.bytes, s.bytes / s.selects,
+           worst[client] / (SystemCoreClock / 1000000));
+}
+
+int main (void) {
+    uint32_t i;
+
+    GPIOInit();
+    UARTInit(115200);
+    SSPInit();
+    oled_init();
+    led7seg_init();
+    cycles_init();
+    SSPSetProfileHook(profile);
+
+    // cada operacao e medida isoladamente
+    SSPResetStats();
+    for (i = 0; i < LOOPS; i++)
+        oled_putString(0, (i % 7) * 8, (uint8_t *)"0123456789ABCDEF",
+                       OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+    printf("oled_putString x%u\n", LOOPS);
+    report("oled", SSP_CLIENT_OLED);
+
+    SSPResetStats();
+    for (i = 0; i < LOOPS; i++)
+        oled_clearScreen(i & 1 ? OLED_COLOR_BLACK : OLED_COLOR_WHITE);
+    printf("oled_clearScreen x%u\n", LOOPS);
+    report("oled", SSP_CLIENT_OLED);
+
+    SSPResetStats();
+    for (i = 0; i < LOOPS; i++)
+        led7seg_setChar('0' + i % 10, FALSE);
+    printf("led7seg_setChar x%u\n", LOOPS);
+    report("led7", SSP_CLIENT_LED7);
+
+    // o mesmo resumo pela UART
+    SSPDumpStats();
+
+    while (1);
+}
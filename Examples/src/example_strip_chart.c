@@ -0,0 +1,57 @@
+#include "libdemo.h"
+/*============================================================================
+ *                  Exemplos de utilizao do RTOS CMSIS
+ *           LPCXpresso 1343 + Embedded Artists Development Board 
+ *---------------------------------------------------------------------------*
+ *                Grafico rolante com a linha inicial do OLED
+ *---------------------------------------------------------------------------*
+ *                    Prof. Andr Schneider de Oliveira
+ *            Universidade Tecnolgica Federal do Paran (UTFPR)
+ *===========================================================================
+ * Obs: Abra a janela Terminal I/O no Debugger - Menu View/Terminal I/O
+ *===========================================================================*/
+
+#define PERIOD      50          // ms entre amostras
+#define SAMPLES     64          // amostras por relatorio
+
+// Grafico rolante do trimpot: a cada amostra so a linha mais antiga do
+// framebuffer e redesenhada e a linha inicial do display avanca uma linha
+void chart_thread(void const *args) {
+    uint32_t n = 0, sum = 0, min = 0xFFFFFFFF, max = 0;
+    uint32_t start, cycles;
+
+    chart_init(0, 1023, OLED_COLOR_WHITE, OLED_COLOR_BLACK);
+    while (1) {
+        osDelay(PERIOD);
+
+        start = cycles_now();
+        chart_add(ADCRead(0));
+        cycles = cycles_now() - start;
+
+        sum += cycles;
+        if (cycles < min) min = cycles;
+        if (cycles > max) max = cycles;
+        if (++n == SAMPLES) {
+            printf("chart_add: min %u, avg %u, max %u cycles\n",
+                   min, sum / n, max);
+            n = sum = max = 0;
+            min = 0xFFFFFFFF;
+        }
+    }
+}
+osThreadDef(chart_thread, osPriorityNormal, 1, 0);
+
+int main (void) {
+    osKernelInitialize();
+
+    GPIOInit();
+    SSPInit();
+    ADCInit(ADC_CLK);
+    oled_init();
+    cycles_init();
+
+    osThreadCreate(osThread(chart_thread), NULL);
+
+    osKernelStart();
+    osDelay(osWaitForever);
+}
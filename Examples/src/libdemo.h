@@ -8,12 +8,18 @@
 #include "led7seg.h"
 #include "i2c.h"
 #include "ssp.h"
+#include "uart.h"
 #include "pca9532.h"
 #include "adc.h"
 #include "light.h"
 #include "temp.h"
 #include "acc.h"
 #include "joystick.h"
+#include "input.h"
+#include "eeprom.h"
+#include "logger.h"
+#include "chart.h"
+#include "ustimer.h"
 
 // Funcoes para demonstrao do CMSIS-RTOS
 
@@ -27,6 +33,22 @@ static uint32_t getTicks(void)
 {
     return msTicks;
 }
+
+// Contador de ciclos do nucleo (DWT) para medidas de desempenho
+static void cycles_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+#define cycles_now()    (DWT->CYCCNT)
+
+// Saida do logger na janela Terminal I/O
+static void log_terminal(uint8_t *buffer, uint32_t length)
+{
+    fwrite(buffer, 1, length, stdout);
+}
     
     int32_t  get_temperature(){   
         return temp_read();
@@ -24,12 +24,25 @@ typedef enum
     ACC_RANGE_4G,
 } acc_range_t;
 
+#define ACC_RING_LEN 32     /* background sampler ring, power of two */
+
+typedef struct
+{
+    uint32_t time;          /* osKernelSysTick() when the sample was read */
+    int8_t x;
+    int8_t y;
+    int8_t z;
+} acc_sample_t;
+
 
 void acc_init (void);
 
 void acc_read (int8_t *x, int8_t *y, int8_t *z);
 void acc_setRange(acc_range_t range);
 void acc_setMode(acc_mode_t mode);
+void acc_startSampler(uint32_t port, uint32_t pin);
+uint32_t acc_getSamples(acc_sample_t *samples, uint32_t max);
+uint32_t acc_getLost(void);
 
 
 
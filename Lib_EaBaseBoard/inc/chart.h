@@ -0,0 +1,19 @@
+/*****************************************************************************
+ *   chart.h:  Header file for the scrolling OLED strip chart
+ *
+******************************************************************************/
+#ifndef __CHART_H
+#define __CHART_H
+
+#include "oled.h"
+
+
+void chart_init (int32_t min, int32_t max, oled_color_t fg, oled_color_t bg);
+void chart_add (int32_t value);
+void chart_stop (void);
+
+
+#endif /* end __CHART_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,36 @@
+/*****************************************************************************
+ *   eecache.h:  Header file for the EEPROM write-back cache
+ *
+******************************************************************************/
+#ifndef __EECACHE_H
+#define __EECACHE_H
+
+#include "eeprom.h"
+
+#define EECACHE_LINES       8       /* cached EEPROM pages */
+#define EECACHE_FLUSH_MS    1000    /* default background flush period */
+
+typedef struct
+{
+    uint32_t hits;          /* page accesses that found the page cached */
+    uint32_t misses;        /* page accesses that allocated a line */
+    uint32_t fills;         /* page loads from the EEPROM */
+    uint32_t unchanged;     /* written bytes equal to the cached value */
+    uint32_t evictions;     /* dirty pages flushed to make room */
+    uint32_t pageWrites;    /* EEPROM page writes issued */
+    uint32_t bytesWritten;  /* bytes sent in those page writes */
+} eecache_stats_t;
+
+
+void eecache_init (void);
+int16_t eecache_read (uint8_t* buf, uint16_t offset, uint16_t len);
+int16_t eecache_write (uint8_t* buf, uint16_t offset, uint16_t len);
+int16_t eecache_flush (void);
+void eecache_startFlusher (uint32_t periodMs);
+void eecache_getStats (eecache_stats_t *stats);
+
+
+#endif /* end __EECACHE_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
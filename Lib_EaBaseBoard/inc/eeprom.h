@@ -8,10 +8,18 @@
 #ifndef __EEPROM_H
 #define __EEPROM_H
 
+#define EEPROM_TOTAL_SIZE 1024
+#define EEPROM_PAGE_SIZE    16
+
 
 void eeprom_init (void);
 int16_t eeprom_read(uint8_t* buf, uint16_t offset, uint16_t len);
 int16_t eeprom_write(uint8_t* buf, uint16_t offset, uint16_t len);
+int16_t eeprom_writeAsync(uint8_t* buf, uint16_t offset, uint16_t len,
+                          void *thread, int32_t signal);
+uint8_t eeprom_writeBusy(void);
+int16_t eeprom_writeResult(void);
+uint32_t eeprom_getPollCount(void);
 
 
 #endif /* end __EEPROM_H */
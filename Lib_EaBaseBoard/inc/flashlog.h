@@ -0,0 +1,35 @@
+/*****************************************************************************
+ *   flashlog.h:  Header file for the append-only record log on the SPI
+ *                flash
+ *
+******************************************************************************/
+#ifndef __FLASHLOG_H
+#define __FLASHLOG_H
+
+#include "flash.h"
+
+#define FLASHLOG_MAX_PAGE   264     /* largest AT45 page size */
+#define FLASHLOG_HDR_SIZE   8       /* page header */
+#define FLASHLOG_REC_OVH    3       /* length byte and CRC of a record */
+
+typedef struct
+{
+    uint32_t page;      /* index in the log area */
+    uint32_t seq;       /* sequence number of the page */
+    uint16_t offset;    /* offset of the next record in the page */
+    uint8_t  done;
+} flashlog_cursor_t;
+
+
+uint32_t flashlog_mount (uint32_t firstPage, uint32_t numPages);
+int16_t flashlog_append (void* data, uint8_t len);
+uint32_t flashlog_sync (void);
+void flashlog_rewind (flashlog_cursor_t *cursor);
+int16_t flashlog_next (flashlog_cursor_t *cursor, void* buf, uint8_t len);
+uint32_t flashlog_getSeq (void);
+
+
+#endif /* end __FLASHLOG_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,34 @@
+/*****************************************************************************
+ *   font.h:  Header file for the packed proportional OLED fonts
+ *
+******************************************************************************/
+#ifndef __FONT_H
+#define __FONT_H
+
+#define FONT_MAX_HEIGHT 24      /* a column and its shift fit in 32 bits */
+
+/*
+ * A glyph is width[ch - first] columns of 'height' pixels. The columns are
+ * packed left to right, top pixel first and LSB first, with no padding
+ * between them; every glyph starts on a byte boundary at
+ * bits[offset[ch - first]]. Codes without a glyph have a width of 0.
+ * The tables are generated from BDF fonts by Tools/bdf2font.
+ */
+typedef struct
+{
+    uint8_t height;
+    uint8_t first;
+    uint8_t last;
+    const uint8_t *width;
+    const uint16_t *offset;
+    const uint8_t *bits;
+} font_t;
+
+/* 16 pixel bold digits, '.', ':', '+', '-' and '%' for numeric readouts */
+extern const font_t font_digits16;
+
+
+#endif /* end __FONT_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -8,7 +8,10 @@
 #ifndef __FONT5x7_H
 #define __FONT5x7_H
 
+#define FONT5X7_WIDTH   6       /* columns per glyph, including spacing */
+
 extern const unsigned char font5x7[][8];
+extern const unsigned char font5x7_cols[][FONT5X7_WIDTH];
 
 
 #endif /* end __FONT5x7_H */
@@ -0,0 +1,1063 @@
+/*****************************************************************************
+ *   font5x7_glyphs.h:  Glyph data of the 5x7 font, characters 0x20 - 0x7f
+ *
+ *   Copyright (c) 2006 Embedded Artists AB
+ *
+ *   Each glyph is 8 rows of 8 bits, the leftmost pixel in the MSB. The
+ *   includer defines FONT_GLYPH(r0, ..., r7) to build a table from it.
+ *   There is no include guard on purpose.
+ *
+******************************************************************************/
+
+/* space */
+ FONT_GLYPH(
+   ________,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________)
+
+/*  !  */
+ FONT_GLYPH(
+   X_______,
+   X_______,
+   X_______,
+   X_______,
+   X_______,
+   ________,
+   X_______,
+   ________)
+
+
+/*  "  */
+ FONT_GLYPH(
+   X_X_____,
+   X_X_____,
+   X_X_____,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________)
+
+/* #  */
+ FONT_GLYPH(
+   _X_X____,
+   _X_X____,
+   XXXXX___,
+   _X_X____,
+   XXXXX___,
+   _X_X____,
+   _X_X____,
+   ________)
+
+/*  $  */
+ FONT_GLYPH(
+   __X_____,
+   _XXXX___,
+   X_X_____,
+   _XXX____,
+   __X_X___,
+   XXXX____,
+   __X_____,
+   ________)
+
+/*  %  */
+ FONT_GLYPH(
+   XX______,
+   XX__X___,
+   ___X____,
+   __X_____,
+   _X______,
+   X__XX___,
+   ___XX___,
+   ________)
+
+/*  &  */
+ FONT_GLYPH(
+   _XX_____,
+   X__X____,
+   X_X_____,
+   _X______,
+   X_X_X___,
+   X__X____,
+   _XX_X___,
+   ________)
+
+/*  '  */
+ FONT_GLYPH(
+   XX______,
+   _X______,
+   X_______,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________)
+
+/*  (  */
+ FONT_GLYPH(
+   __X_____,
+   _X______,
+   X_______,
+   X_______,
+   X_______,
+   _X______,
+   __X_____,
+   ________)
+
+/*  )  */
+ FONT_GLYPH(
+   X_______,
+   _X______,
+   __X_____,
+   __X_____,
+   __X_____,
+   _X______,
+   X_______,
+   ________)
+
+/*  *  */
+ FONT_GLYPH(
+   ________,
+   _X_X____,
+   __X_____,
+   XXXXX___,
+   __X_____,
+   _X_X____,
+   ________,
+   ________)
+
+ FONT_GLYPH(
+   ________,
+   __X_____,
+   __X_____,
+   XXXXX___,
+   __X_____,
+   __X_____,
+   ________,
+   ________)
+
+ FONT_GLYPH(
+   ________,
+   ________,
+   ________,
+   ________,
+   ________,
+   XX______,
+   _X______,
+   X_______)
+
+ FONT_GLYPH(
+   ________,
+   ________,
+   ________,
+   XXXXX___,
+   ________,
+   ________,
+   ________,
+   ________)
+
+ FONT_GLYPH(
+   ________,
+   ________,
+   ________,
+   ________,
+   ________,
+   XX______,
+   XX______,
+   ________)
+
+ FONT_GLYPH(
+   ________,
+   ____X___,
+   ___X____,
+   __X_____,
+   _X______,
+   X_______,
+   ________,
+   ________)
+
+/* 0 */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   X__XX___,
+   X_X_X___,
+   XX__X___,
+   X___X___,
+   _XXX____,
+   ________)
+
+/* 1 */
+ FONT_GLYPH(
+   __X_____,
+   _XX_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   _XXX____,
+   ________)
+
+/* 2 */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   ____X___,
+   __XX____,
+   _X______,
+   X_______,
+   XXXXX___,
+   ________)
+
+/* 3 */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   ____X___,
+   __XX____,
+   ____X___,
+   X___X___,
+   _XXX____,
+   ________)
+
+/* 4 */
+ FONT_GLYPH(
+   ___X____,
+   __XX____,
+   _X_X____,
+   X__X____,
+   XXXXX___,
+   ___X____,
+   ___X____,
+   ________)
+
+/* 5 */
+ FONT_GLYPH(
+   XXXXX___,
+   X_______,
+   XXXX____,
+   ____X___,
+   ____X___,
+   X___X___,
+   _XXX____,
+   ________)
+
+/* 6 */
+ FONT_GLYPH(
+   __XX____,
+   _X______,
+   X_______,
+   XXXX____,
+   X___X___,
+   X___X___,
+   _XXX____,
+   ________)
+
+/* 7 */
+ FONT_GLYPH(
+   XXXXX___,
+   ____X___,
+   ___X____,
+   __X_____,
+   _X______,
+   _X______,
+   _X______,
+   ________)
+
+/* 8 */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   X___X___,
+   _XXX____,
+   X___X___,
+   X___X___,
+   _XXX____,
+   ________)
+
+/* 9 */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   X___X___,
+   _XXXX___,
+   ____X___,
+   ___X____,
+   _XX_____,
+   ________)
+
+/* ':' 3a */
+ FONT_GLYPH(
+   ________,
+   XX______,
+   XX______,
+   ________,
+   XX______,
+   XX______,
+   ________,
+   ________)
+
+/* ';' 3b */
+ FONT_GLYPH(
+   ________,
+   ________,
+   XX______,
+   XX______,
+   ________,
+   XX______,
+   _X______,
+   X_______)
+
+
+/* '<' 3c */
+ FONT_GLYPH(
+   ___X____,
+   __X_____,
+   _X______,
+   X_______,
+   _X______,
+   __X_____,
+   ___X____,
+   ________)
+
+/* '=' 3d */
+ FONT_GLYPH(
+   ________,
+   ________,
+   XXXXX___,
+   ________,
+   XXXXX___,
+   ________,
+   ________,
+   ________)
+
+/* '>' */
+ FONT_GLYPH(
+   X_______,
+   _X______,
+   __X_____,
+   ___X____,
+   __X_____,
+   _X______,
+   X_______,
+   ________)
+
+/* '?' */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   ____X___,
+   ___X____,
+   __X_____,
+   ________,
+   __X_____,
+   ________)
+
+/* @ */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   ____X___,
+   _XX_X___,
+   X_X_X___,
+   X_X_X___,
+   _XXX____,
+   ________)
+
+/* A */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   X___X___,
+   XXXXX___,
+   X___X___,
+   X___X___,
+   X___X___,
+   ________)
+
+/* B */
+ FONT_GLYPH(
+   XXXX____,
+   X___X___,
+   X___X___,
+   XXXX____,
+   X___X___,
+   X___X___,
+   XXXX____,
+   ________)
+
+/* C */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   X_______,
+   X_______,
+   X_______,
+   X___X___,
+   _XXX____,
+   ________)
+
+/* D */
+ FONT_GLYPH(
+   XXX_____,
+   X__X____,
+   X___X___,
+   X___X___,
+   X___X___,
+   X__X____,
+   XXX_____,
+   ________)
+
+/* E */
+ FONT_GLYPH(
+   XXXXX___,
+   X_______,
+   X_______,
+   XXXX____,
+   X_______,
+   X_______,
+   XXXXX___,
+   ________)
+
+/* F */
+ FONT_GLYPH(
+   XXXXX___,
+   X_______,
+   X_______,
+   XXXX____,
+   X_______,
+   X_______,
+   X_______,
+   ________)
+
+/* G */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   X_______,
+   X_______,
+   X__XX___,
+   X___X___,
+   _XXXX___,
+   ________)
+
+/* H */
+ FONT_GLYPH(
+   X___X___,
+   X___X___,
+   X___X___,
+   XXXXX___,
+   X___X___,
+   X___X___,
+   X___X___,
+   ________)
+
+/* I */
+ FONT_GLYPH(
+   XXX_____,
+   _X______,
+   _X______,
+   _X______,
+   _X______,
+   _X______,
+   XXX_____,
+   ________)
+
+/* J */
+ FONT_GLYPH(
+   __XXX___,
+   ___X____,
+   ___X____,
+   ___X____,
+   ___X____,
+   X__X____,
+   _XX_____,
+   ________)
+
+/* K */
+ FONT_GLYPH(
+   X___X___,
+   X__X____,
+   X_X_____,
+   XX______,
+   X_X_____,
+   X__X____,
+   X___X___,
+   ________)
+
+/* L */
+ FONT_GLYPH(
+   X_______,
+   X_______,
+   X_______,
+   X_______,
+   X_______,
+   X_______,
+   XXXXX___,
+   ________)
+
+/* M */
+ FONT_GLYPH(
+   X___X___,
+   XX_XX___,
+   X_X_X___,
+   X_X_X___,
+   X___X___,
+   X___X___,
+   X___X___,
+   ________)
+
+/* N */
+ FONT_GLYPH(
+   X___X___,
+   X___X___,
+   XX__X___,
+   X_X_X___,
+   X__XX___,
+   X___X___,
+   X___X___,
+   ________)
+
+/* O */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   X___X___,
+   X___X___,
+   X___X___,
+   X___X___,
+   _XXX____,
+   ________)
+
+/* P */
+ FONT_GLYPH(
+   XXXX____,
+   X___X___,
+   X___X___,
+   XXXX____,
+   X_______,
+   X_______,
+   X_______,
+   ________)
+
+/* Q */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   X___X___,
+   X___X___,
+   X_X_X___,
+   X__X____,
+   _XX_X___,
+   ________)
+
+/* R */
+ FONT_GLYPH(
+   XXXX____,
+   X___X___,
+   X___X___,
+   XXXX____,
+   X_X_____,
+   X__X____,
+   X___X___,
+   ________)
+
+/* S */
+ FONT_GLYPH(
+   _XXX____,
+   X___X___,
+   X_______,
+   _XXX____,
+   ____X___,
+   X___X___,
+   _XXX____,
+   ________)
+
+/* T */
+ FONT_GLYPH(
+   XXXXX___,
+   __X_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   ________)
+
+/* U */
+ FONT_GLYPH(
+   X___X___,
+   X___X___,
+   X___X___,
+   X___X___,
+   X___X___,
+   X___X___,
+   _XXX____,
+   ________)
+
+/* V */
+ FONT_GLYPH(
+   X___X___,
+   X___X___,
+   X___X___,
+   X___X___,
+   X___X___,
+   _X_X____,
+   __X_____,
+   ________)
+
+/* W */
+ FONT_GLYPH(
+   X___X___,
+   X___X___,
+   X___X___,
+   X_X_X___,
+   X_X_X___,
+   X_X_X___,
+   _X_X____,
+   ________)
+
+/* X */
+ FONT_GLYPH(
+   X___X___,
+   X___X___,
+   _X_X____,
+   __X_____,
+   _X_X____,
+   X___X___,
+   X___X___,
+   ________)
+
+/* Y */
+ FONT_GLYPH(
+   X___X___,
+   X___X___,
+   _X_X____,
+   __X_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   ________)
+
+/* Z */
+ FONT_GLYPH(
+   XXXXX___,
+   ____X___,
+   ___X____,
+   __X_____,
+   _X______,
+   X_______,
+   XXXXX___,
+   ________)
+
+/* 5b */
+ FONT_GLYPH(
+   XXX_____,
+   X_______,
+   X_______,
+   X_______,
+   X_______,
+   X_______,
+   XXX_____,
+   ________)
+
+/* 5c */
+ FONT_GLYPH(
+   ________,
+   X_______,
+   _X______,
+   __X_____,
+   ___X____,
+   ____X___,
+   ________,
+   ________)
+
+/* 5d */
+ FONT_GLYPH(
+   XXX_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   XXX_____,
+   ________)
+
+/* 5e */
+ FONT_GLYPH(
+   __X_____,
+   _X_X____,
+   X___X___,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________)
+
+/* 5f */
+ FONT_GLYPH(
+   ________,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________,
+   XXXXX___)
+
+/* 60 */
+ FONT_GLYPH(
+   X_______,
+   _X______,
+   __X_____,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________)
+
+/* a */
+ FONT_GLYPH(
+   ________,
+   ________,
+   _XXX____,
+   ____X___,
+   _XXXX___,
+   X___X___,
+   _XXXX___,
+   ________)
+
+/* b */
+ FONT_GLYPH(
+   X_______,
+   X_______,
+   X_XX____,
+   XX__X___,
+   X___X___,
+   X___X___,
+   XXXX____,
+   ________)
+
+/* c */
+ FONT_GLYPH(
+   ________,
+   ________,
+   _XX_____,
+   X__X____,
+   X_______,
+   X__X____,
+   _XX_____,
+   ________)
+
+/* d */
+ FONT_GLYPH(
+   ____X___,
+   ____X___,
+   _XX_X___,
+   X__XX___,
+   X___X___,
+   X___X___,
+   _XXXX___,
+   ________)
+
+/* e */
+ FONT_GLYPH(
+   ________,
+   ________,
+   _XXX____,
+   X___X___,
+   XXXXX___,
+   X_______,
+   _XXX____,
+   ________)
+
+/* f */
+ FONT_GLYPH(
+   __X_____,
+   _X_X____,
+   _X______,
+   XXX_____,
+   _X______,
+   _X______,
+   _X______,
+   ________)
+
+/* g */
+ FONT_GLYPH(
+   ________,
+   ________,
+   _XXXX___,
+   X___X___,
+   X___X___,
+   _XXXX___,
+   ____X___,
+   _XXX____)
+
+/* h */
+ FONT_GLYPH(
+   X_______,
+   X_______,
+   X_XX____,
+   XX__X___,
+   X___X___,
+   X___X___,
+   X___X___,
+   ________)
+
+/* i */
+ FONT_GLYPH(
+   _X______,
+   ________,
+   _X______,
+   _X______,
+   _X______,
+   _X______,
+   _X______,
+   ________)
+
+/* j */
+ FONT_GLYPH(
+   __X_____,
+   ________,
+   _XX_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   __X_____,
+   XX______)
+
+/* k */
+ FONT_GLYPH(
+   X_______,
+   X_______,
+   X__X____,
+   X_X_____,
+   XX______,
+   X_X_____,
+   X__X____,
+   ________)
+
+/* l */
+ FONT_GLYPH(
+   XX______,
+   _X______,
+   _X______,
+   _X______,
+   _X______,
+   _X______,
+   XXX_____,
+   ________)
+
+/* m */
+ FONT_GLYPH(
+   ________,
+   ________,
+   XX_X____,
+   X_X_X___,
+   X_X_X___,
+   X___X___,
+   X___X___,
+   ________)
+
+/* n */
+ FONT_GLYPH(
+   ________,
+   ________,
+   X_XX____,
+   XX_X____,
+   X__X____,
+   X__X____,
+   X__X____,
+   ________)
+
+/* o */
+ FONT_GLYPH(
+   ________,
+   ________,
+   _XX_____,
+   X__X____,
+   X__X____,
+   X__X____,
+   _XX_____,
+   ________)
+
+/* p */
+ FONT_GLYPH(
+   ________,
+   ________,
+   XXX_____,
+   X__X____,
+   X__X____,
+   XXX_____,
+   X_______,
+   X_______)
+
+/* q */
+ FONT_GLYPH(
+   ________,
+   ________,
+   _XXX____,
+   X__X____,
+   X__X____,
+   _XXX____,
+   ___X____,
+   ___X____)
+
+/* r */
+ FONT_GLYPH(
+   ________,
+   ________,
+   _X_X____,
+   _XX_____,
+   _X______,
+   _X______,
+   _X______,
+   ________)
+
+/* s */
+ FONT_GLYPH(
+   ________,
+   ________,
+   _XXX____,
+   X_______,
+   _XX_____,
+   ___X____,
+   XXX_____,
+   ________)
+
+/* t */
+ FONT_GLYPH(
+   _X______,
+   _X______,
+   XXX_____,
+   _X______,
+   _X______,
+   _X______,
+   _XX_____,
+   ________)
+
+/* u */
+ FONT_GLYPH(
+   ________,
+   ________,
+   X__X____,
+   X__X____,
+   X__X____,
+   X__X____,
+   _XXX____,
+   ________)
+
+/* v */
+ FONT_GLYPH(
+   ________,
+   ________,
+   X___X___,
+   X___X___,
+   X___X___,
+   _X_X____,
+   __X_____,
+   ________)
+
+/* w */
+ FONT_GLYPH(
+   ________,
+   ________,
+   X___X___,
+   X___X___,
+   X_X_X___,
+   X_X_X___,
+   _X_X____,
+   ________)
+
+/* X */
+ FONT_GLYPH(
+   ________,
+   ________,
+   X___X___,
+   _X_X____,
+   __X_____,
+   _X_X____,
+   X___X___,
+   ________)
+
+/* y */
+ FONT_GLYPH(
+   ________,
+   ________,
+   X__X____,
+   X__X____,
+   X__X____,
+   _XXX____,
+   ___X____,
+   _XX_____)
+
+/* z */
+ FONT_GLYPH(
+   ________,
+   ________,
+   XXXXX___,
+   ___X____,
+   __X_____,
+   _X______,
+   XXXXX___,
+   ________)
+
+/* 0x7b */
+ FONT_GLYPH(
+   __X_____,
+   _X______,
+   _X______,
+   X_______,
+   _X______,
+   _X______,
+   __X_____,
+   ________)
+
+/* 0x7c */
+ FONT_GLYPH(
+   _X______,
+   _X______,
+   _X______,
+   _X______,
+   _X______,
+   _X______,
+   _X______,
+   ________)
+
+/* 0x7d */
+ FONT_GLYPH(
+   X_______,
+   _X______,
+   _X______,
+   __X_____,
+   _X______,
+   _X______,
+   X_______,
+   ________)
+
+/* 0x7e */
+ FONT_GLYPH(
+   _XX_X___,
+   X__X____,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________,
+   ________)
+
+/* 0x7f */
+ FONT_GLYPH(
+   XXXXX___,
+   XXXXX___,
+   XXXXX___,
+   XXXXX___,
+   XXXXX___,
+   XXXXX___,
+   XXXXX___,
+   ________)
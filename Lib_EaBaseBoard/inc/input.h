@@ -0,0 +1,36 @@
+/*****************************************************************************
+ *   input.h:  Header file for the joystick/rotary input event engine
+ *
+******************************************************************************/
+#ifndef __INPUT_H
+#define __INPUT_H
+
+#include "joystick.h"
+#include "rotary.h"
+
+#define INPUT_QUEUE_LEN     16
+#define INPUT_DEBOUNCE_MS   20      /* default joystick debounce window */
+
+/* event types */
+#define INPUT_JOYSTICK_PRESS    1   /* code is a JOYSTICK_xxx bit */
+#define INPUT_JOYSTICK_RELEASE  2   /* code is a JOYSTICK_xxx bit */
+#define INPUT_ROTARY            3   /* code is ROTARY_RIGHT or ROTARY_LEFT */
+
+typedef struct
+{
+    uint8_t  type;
+    uint8_t  code;
+    uint32_t time;      /* getMsTicks() at the first edge */
+} input_event_t;
+
+
+void input_init (uint32_t (*getMsTicks)(void), uint32_t debounceMs);
+void input_setDebounce (uint32_t debounceMs);
+uint8_t input_getEvent (input_event_t *event, uint32_t millisec);
+uint32_t input_getDropped (void);
+
+
+#endif /* end __INPUT_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
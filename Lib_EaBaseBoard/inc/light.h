@@ -41,6 +41,10 @@ typedef enum
 } light_cycle_t;
 
 
+#define LIGHT_WINDOW_PCT 10   /* default threshold window, +/- percent */
+#define LIGHT_QUEUE_LEN  4
+
+
 void light_init (void);
 void light_enable (void);
 uint32_t light_read(void);
@@ -53,6 +57,11 @@ void light_setIrqInCycles(light_cycle_t cycles);
 uint8_t light_getIrqStatus(void);
 void light_clearIrqStatus(void);
 void light_shutdown(void);
+void light_startMonitor(uint32_t port, uint32_t pin, uint32_t pct,
+                        light_cycle_t cycles);
+uint8_t light_waitChange(uint32_t *lux, uint32_t millisec);
+uint32_t light_getLast(void);
+uint32_t light_getIrqCount(void);
 
 
 #endif /* end __LIGHT_H */
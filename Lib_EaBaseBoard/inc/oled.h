@@ -8,8 +8,11 @@
 #ifndef __OLED_H
 #define __OLED_H
 
+#include "font.h"
+
 #define OLED_DISPLAY_WIDTH  96
 #define OLED_DISPLAY_HEIGHT 64
+#define OLED_PAGES          (OLED_DISPLAY_HEIGHT/8)
 
 
 typedef enum
@@ -18,6 +21,15 @@ typedef enum
     OLED_COLOR_WHITE
 } oled_color_t;
 
+/* raster operations of oled_blit, the bitmap is the source */
+typedef enum
+{
+    OLED_ROP_COPY,
+    OLED_ROP_OR,
+    OLED_ROP_AND,
+    OLED_ROP_XOR
+} oled_rop_t;
+
 
 void oled_init (void);
 void oled_putPixel(uint8_t x, uint8_t y, oled_color_t color);
@@ -26,9 +38,19 @@ void oled_circle(uint8_t x0, uint8_t y0, uint8_t r, oled_color_t color);
 void oled_rect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t color);
 void oled_fillRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t color);
 void oled_clearScreen(oled_color_t color);
+void oled_blit(int16_t x, int16_t y, uint8_t w, uint8_t h,
+        const uint8_t *bitmap, oled_rop_t rop);
 void oled_putString(uint8_t x, uint8_t y, uint8_t *pStr, oled_color_t fb,
         oled_color_t bg);
 uint8_t oled_putChar(uint8_t x, uint8_t y, uint8_t ch, oled_color_t fb, oled_color_t bg);
+uint8_t oled_putText(uint8_t x, uint8_t y, uint8_t *pStr, const font_t *font,
+        oled_color_t fb, oled_color_t bg);
+uint16_t oled_textWidth(uint8_t *pStr, const font_t *font);
+void oled_setRetained(uint8_t enable);
+void oled_flush(void);
+void oled_setDoubleBuffered(uint8_t enable);
+void oled_swap(void);
+void oled_setStartLine(uint8_t line);
 
 
 #endif /* end __OLED_H */
@@ -8,6 +8,11 @@
 #ifndef __TEMP_H
 #define __TEMP_H
 
+/* Uncomment to time the sensor with a timer capture input, see temp.c */
+//#define TEMP_USE_CAPTURE 1
+
+/* temp_read result when the capture timer saw no sensor output */
+#define TEMP_NO_READING ((int32_t)0x80000000)
 
 void temp_init (uint32_t (*getMsTick)(void));
 int32_t temp_read(void);
@@ -8,7 +8,8 @@
 
 /*
  * NOTE: I2C must have been initialized before calling any functions in this
- * file.
+ * file. The background sampler also needs GPIOInit and a running RTX
+ * kernel.
  */
 
 /******************************************************************************
@@ -18,6 +19,8 @@
 #include "mcu_regs.h"
 #include "type.h"
 #include "i2c.h"
+#include "gpio.h"
+#include "cmsis_os.h"
 #include "acc.h"
 
 /******************************************************************************
@@ -65,6 +68,10 @@
 #define ACC_STATUS_DOVR 0x02
 #define ACC_STATUS_PERR 0x04
 
+#define ACC_RING_MASK   (ACC_RING_LEN - 1)
+#define SIG_DRDY        0x01
+#define DRDY_POLL_MS    20      /* recovers from a missed DRDY edge */
+
 
 /******************************************************************************
  * External global variables
@@ -74,6 +81,14 @@
  * Local variables
  *****************************************************************************/
 
+static acc_sample_t ring[ACC_RING_LEN];
+static volatile uint32_t ringHead = 0;     /* written by the sampler */
+static volatile uint32_t ringTail = 0;     /* read by acc_getSamples */
+static volatile uint32_t ringLost = 0;
+
+static gpio_pin_t drdyPin;
+static osThreadId samplerThread = NULL;
+
 static uint8_t getStatus(void)
 {
     uint8_t buf[1];
@@ -109,6 +124,56 @@ static void setModeControl(uint8_t mctl)
  * Local Functions
  *****************************************************************************/
 
+/* XOUT8, YOUT8 and ZOUT8 with one register pointer write and a repeated
+ * start read of three auto-incremented registers */
+static void readXYZ(int8_t *x, int8_t *y, int8_t *z)
+{
+    uint8_t reg = ACC_ADDR_XOUT8;
+    uint8_t buf[3];
+
+    I2CWriteRead(ACC_I2C_ADDR, &reg, 1, buf, 3);
+
+    *x = (int8_t)buf[0];
+    *y = (int8_t)buf[1];
+    *z = (int8_t)buf[2];
+}
+
+static void drdyIrq(uint32_t port, uint32_t pin, void *arg)
+{
+    osSignalSet(samplerThread, SIG_DRDY);
+}
+
+static void accSamplerTask(void const *args)
+{
+    acc_sample_t *s;
+    uint32_t primask;
+
+    while (1) {
+        /* DRDY stays high until the data is read, so a missed edge is
+         * caught by looking at the level after a short timeout */
+        if (!GPIOPinGet(drdyPin)) {
+            osSignalWait(SIG_DRDY, DRDY_POLL_MS);
+            if (!GPIOPinGet(drdyPin)) {
+                continue;
+            }
+        }
+
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if (ringHead - ringTail >= ACC_RING_LEN) {
+            ringTail++;             /* full, drop the oldest sample */
+            ringLost++;
+        }
+        __set_PRIMASK(primask);
+
+        s = &ring[ringHead & ACC_RING_MASK];
+        s->time = osKernelSysTick();
+        readXYZ(&s->x, &s->y, &s->z);
+        ringHead++;
+    }
+}
+osThreadDef(accSamplerTask, osPriorityAboveNormal, 1, 0);
+
 /******************************************************************************
  * Public Functions
  *****************************************************************************/
@@ -142,32 +207,76 @@ void acc_init (void)
  *****************************************************************************/
 void acc_read (int8_t *x, int8_t *y, int8_t *z)
 {
-    uint8_t buf[1];
-
     /* wait for ready flag */
     while ((getStatus() & ACC_STATUS_DRDY) == 0);
 
-    /*
-     * Have experienced problems reading all registers
-     * at once. Change to reading them one-by-one
-    */
-    buf[0] = ACC_ADDR_XOUT8;
-    I2CWrite(ACC_I2C_ADDR, buf, 1);
-    I2CRead(ACC_I2C_ADDR, buf, 1);
-
-    *x = (int8_t)buf[0];
-
-    buf[0] = ACC_ADDR_YOUT8;
-    I2CWrite(ACC_I2C_ADDR, buf, 1);
-    I2CRead(ACC_I2C_ADDR, buf, 1);
+    readXYZ(x, y, z);
+}
 
-    *y = (int8_t)buf[0];
+/******************************************************************************
+ *
+ * Description:
+ *    Start sampling at the sensor's output rate in the background. The
+ *    MMA7455 signals data ready on INT1; the pin it is wired to is given
+ *    as parameter. Each sample is read with a single burst transfer and
+ *    stored in a ring of ACC_RING_LEN entries.
+ *
+ * Params:
+ *   [in] port - GPIO port of the INT1/DRDY line
+ *   [in] pin - GPIO pin of the INT1/DRDY line
+ *
+ *****************************************************************************/
+void acc_startSampler(uint32_t port, uint32_t pin)
+{
+    ringHead = ringTail = 0;
+    ringLost = 0;
+    drdyPin = GPIO_PIN(port, pin);
+
+    if (samplerThread == NULL) {
+        samplerThread = osThreadCreate(osThread(accSamplerTask), NULL);
+    }
+    GPIOAttachIrq(port, pin, GPIO_EDGE_RISING, drdyIrq, NULL);
+}
 
-    buf[0] = ACC_ADDR_ZOUT8;
-    I2CWrite(ACC_I2C_ADDR, buf, 1);
-    I2CRead(ACC_I2C_ADDR, buf, 1);
+/******************************************************************************
+ *
+ * Description:
+ *    Take samples from the background sampler ring, oldest first
+ *
+ * Params:
+ *   [out] samples - destination
+ *   [in] max - number of entries in samples
+ *
+ * Returns:
+ *    Number of samples copied
+ *
+ *****************************************************************************/
+uint32_t acc_getSamples(acc_sample_t *samples, uint32_t max)
+{
+    uint32_t n = 0;
+    uint32_t primask;
+
+    /* the sampler moves the tail too when the ring is full */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    while (n < max && ringTail != ringHead) {
+        samples[n++] = ring[ringTail & ACC_RING_MASK];
+        ringTail++;
+    }
+    __set_PRIMASK(primask);
+
+    return n;
+}
 
-    *z = (int8_t)buf[0];
+/******************************************************************************
+ *
+ * Description:
+ *    Number of samples overwritten before they were taken
+ *
+ *****************************************************************************/
+uint32_t acc_getLost(void)
+{
+    return ringLost;
 }
 
 /******************************************************************************
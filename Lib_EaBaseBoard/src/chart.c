@@ -0,0 +1,162 @@
+/*****************************************************************************
+ *   chart.c:  Strip chart scrolled with the OLED display start line
+ *
+ ******************************************************************************/
+
+/*
+ * NOTE: the chart uses the whole display. Samples are plotted as rows, the
+ * value along x from min (left) to max (right), the newest sample at the
+ * bottom. Adding a sample redraws only the framebuffer row that held the
+ * oldest sample and advances the display start line by one, so the
+ * hardware scrolls the older samples up. The cost of a sample depends only
+ * on the width of the old and new trace segments in that row, never on
+ * the number of samples shown.
+ *
+ * Other drawing on the display scrolls along with the chart; call
+ * chart_stop before drawing anything else.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "mcu_regs.h"
+#include "type.h"
+#include "chart.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+
+#define CHART_ROWS  OLED_DISPLAY_HEIGHT
+
+/******************************************************************************
+ * External global variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+static int32_t chartMin;
+static int32_t chartMax;
+static oled_color_t chartFg;
+static oled_color_t chartBg;
+
+/* framebuffer row at the top of the panel, holds the oldest sample */
+static uint8_t top;
+
+/* x of the previous sample, the trace is joined to it */
+static uint8_t lastX;
+static uint8_t hasLast;
+
+/* columns lit in each framebuffer row, empty when lo > hi */
+static uint8_t rowLo[CHART_ROWS];
+static uint8_t rowHi[CHART_ROWS];
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+static uint8_t valueToX(int32_t value)
+{
+    if (value <= chartMin) {
+        return 0;
+    }
+    if (value >= chartMax) {
+        return OLED_DISPLAY_WIDTH - 1;
+    }
+
+    return (uint8_t)(((value - chartMin) * (OLED_DISPLAY_WIDTH - 1))
+                     / (chartMax - chartMin));
+}
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * Description:
+ *    Clear the display and start an empty chart
+ *
+ * Params:
+ *   [in] min - value plotted at the left edge
+ *   [in] max - value plotted at the right edge, (max - min) * 95 must
+ *              fit in 31 bits
+ *   [in] fg - color of the trace
+ *   [in] bg - background color
+ *
+ *****************************************************************************/
+void chart_init (int32_t min, int32_t max, oled_color_t fg, oled_color_t bg)
+{
+    uint8_t i;
+
+    chartMin = min;
+    chartMax = (max > min) ? max : min + 1;
+    chartFg = fg;
+    chartBg = bg;
+    top = 0;
+    hasLast = 0;
+
+    for (i = 0; i < CHART_ROWS; i++) {
+        rowLo[i] = 1;
+        rowHi[i] = 0;
+    }
+
+    oled_setStartLine(0);
+    oled_clearScreen(bg);
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Add a sample at the bottom of the chart and scroll the older ones up
+ *    one row
+ *
+ * Params:
+ *   [in] value - sample, clipped to min..max
+ *
+ *****************************************************************************/
+void chart_add (int32_t value)
+{
+    uint8_t row = top;
+    uint8_t x = valueToX(value);
+    uint8_t x0 = x;
+    uint8_t x1 = x;
+
+    if (hasLast) {
+        if (lastX < x0) {
+            x0 = lastX;
+        }
+        if (lastX > x1) {
+            x1 = lastX;
+        }
+    }
+
+    /* erase the oldest sample, its row becomes the bottom row */
+    if (rowLo[row] <= rowHi[row]) {
+        oled_fillRect(rowLo[row], row, rowHi[row], row, chartBg);
+    }
+    oled_fillRect(x0, row, x1, row, chartFg);
+    rowLo[row] = x0;
+    rowHi[row] = x1;
+
+    lastX = x;
+    hasLast = 1;
+
+    top = (row + 1) & (CHART_ROWS - 1);
+    oled_setStartLine(top);
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Stop the chart, reset the start line and clear the display
+ *
+ *****************************************************************************/
+void chart_stop (void)
+{
+    oled_setStartLine(0);
+    oled_clearScreen(chartBg);
+}
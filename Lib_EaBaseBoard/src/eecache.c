@@ -0,0 +1,367 @@
+/*****************************************************************************
+ *   eecache.c:  Write-back cache for parameters stored in the EEPROM
+ *
+ ******************************************************************************/
+
+/*
+ * NOTE: I2C must have been initialized and osKernelInitialize called before
+ * eecache_init. Data written through the cache only reaches the EEPROM on
+ * eecache_flush, when a dirty page is evicted, or from the flush thread.
+ *
+ * The cache holds whole 16 byte EEPROM pages. A page is loaded on the
+ * first read; a write only loads it when the page is flushed with bytes
+ * that were never read or written. Each line keeps a mask of the dirty
+ * bytes and a flush writes the span from the first to the last dirty byte
+ * as one page write, so any number of field updates within a page cost
+ * a single write cycle. Bytes written with their current value are not
+ * marked dirty.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "mcu_regs.h"
+#include "type.h"
+#include "string.h"
+#include "cmsis_os.h"
+#include "eecache.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+
+#ifndef MIN
+#define MIN(x, y) ((x) < (y) ? (x) : (y))
+#endif
+
+#define NO_PAGE     0xFFFF
+#define ALL_BYTES   0xFFFF
+
+typedef struct
+{
+    uint16_t page;          /* EEPROM page number or NO_PAGE */
+    uint16_t valid;         /* byte mask, set when data[n] is known */
+    uint16_t dirty;         /* byte mask, set when data[n] is not written */
+    uint32_t used;          /* LRU stamp */
+    uint8_t  data[EEPROM_PAGE_SIZE];
+} line_t;
+
+/******************************************************************************
+ * External global variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+static line_t lines[EECACHE_LINES];
+static uint32_t useCount = 0;
+static eecache_stats_t cacheStats;
+static uint32_t flushPeriod = EECACHE_FLUSH_MS;
+static osThreadId flushThread = NULL;
+
+osMutexDef(eecache_mutex);
+static osMutexId cacheMutex = NULL;
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/* read the bytes of the page that are not valid yet */
+static int fillLine(line_t *line)
+{
+    uint8_t tmp[EEPROM_PAGE_SIZE];
+    int i;
+
+    if (line->valid == ALL_BYTES) {
+        return 0;
+    }
+    if (eeprom_read(tmp, line->page * EEPROM_PAGE_SIZE,
+                    EEPROM_PAGE_SIZE) < 0) {
+        return -1;
+    }
+    cacheStats.fills++;
+
+    for (i = 0; i < EEPROM_PAGE_SIZE; i++) {
+        if ((line->valid & (1 << i)) == 0) {
+            line->data[i] = tmp[i];
+        }
+    }
+    line->valid = ALL_BYTES;
+
+    return 0;
+}
+
+static int flushLine(line_t *line)
+{
+    int first = 0;
+    int last = EEPROM_PAGE_SIZE - 1;
+    uint16_t span;
+
+    if (line->dirty == 0) {
+        return 0;
+    }
+
+    while ((line->dirty & (1 << first)) == 0) {
+        first++;
+    }
+    while ((line->dirty & (1 << last)) == 0) {
+        last--;
+    }
+
+    /* clean bytes between dirty ones are rewritten with their value */
+    span = (2 << last) - (1 << first);
+    if ((line->valid & span) != span) {
+        if (fillLine(line) != 0) {
+            return -1;
+        }
+    }
+
+    if (eeprom_write(&line->data[first], line->page * EEPROM_PAGE_SIZE + first,
+                     last - first + 1) < 0) {
+        return -1;
+    }
+
+    cacheStats.pageWrites++;
+    cacheStats.bytesWritten += last - first + 1;
+    line->dirty = 0;
+
+    return 0;
+}
+
+static line_t* getLine(uint16_t page)
+{
+    line_t *victim = &lines[0];
+    int i;
+
+    for (i = 0; i < EECACHE_LINES; i++) {
+        if (lines[i].page == page) {
+            lines[i].used = ++useCount;
+            cacheStats.hits++;
+            return &lines[i];
+        }
+        if (lines[i].page == NO_PAGE) {
+            victim = &lines[i];
+            victim->used = 0;
+        }
+        else if (victim->page != NO_PAGE && lines[i].used < victim->used) {
+            victim = &lines[i];
+        }
+    }
+
+    cacheStats.misses++;
+
+    if (victim->dirty != 0) {
+        cacheStats.evictions++;
+        if (flushLine(victim) != 0) {
+            return NULL;
+        }
+    }
+
+    victim->page = page;
+    victim->valid = 0;
+    victim->dirty = 0;
+    victim->used = ++useCount;
+
+    return victim;
+}
+
+static void eecacheFlushTask(void const *args)
+{
+    while (1) {
+        osDelay(flushPeriod);
+        eecache_flush();
+    }
+}
+osThreadDef(eecacheFlushTask, osPriorityLow, 1, 0);
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * Description:
+ *    Initialize the cache. All lines are invalidated, dirty data is
+ *    discarded.
+ *
+ *****************************************************************************/
+void eecache_init (void)
+{
+    int i;
+
+    for (i = 0; i < EECACHE_LINES; i++) {
+        lines[i].page = NO_PAGE;
+        lines[i].valid = 0;
+        lines[i].dirty = 0;
+    }
+    memset(&cacheStats, 0, sizeof(cacheStats));
+
+    if (cacheMutex == NULL) {
+        cacheMutex = osMutexCreate(osMutex(eecache_mutex));
+    }
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Read through the cache
+ *
+ * Params:
+ *   [in] buf - read buffer
+ *   [in] offset - offset to start to read from
+ *   [in] len - number of bytes to read
+ *
+ * Returns:
+ *   number of read bytes or -1 in case of an error
+ *
+ *****************************************************************************/
+int16_t eecache_read (uint8_t* buf, uint16_t offset, uint16_t len)
+{
+    uint16_t done = 0;
+    uint16_t off, n;
+    line_t *line;
+
+    if (len > EEPROM_TOTAL_SIZE || offset+len > EEPROM_TOTAL_SIZE) {
+        return -1;
+    }
+
+    osMutexWait(cacheMutex, osWaitForever);
+
+    while (done < len) {
+        off = (offset + done) % EEPROM_PAGE_SIZE;
+        n = MIN(EEPROM_PAGE_SIZE - off, len - done);
+
+        line = getLine((offset + done) / EEPROM_PAGE_SIZE);
+        if (line == NULL || fillLine(line) != 0) {
+            osMutexRelease(cacheMutex);
+            return -1;
+        }
+        memcpy(&buf[done], &line->data[off], n);
+        done += n;
+    }
+
+    osMutexRelease(cacheMutex);
+
+    return len;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Write into the cache. The data is written to the EEPROM later.
+ *
+ * Params:
+ *   [in] buf - data to write
+ *   [in] offset - offset to start to write to
+ *   [in] len - number of bytes to write
+ *
+ * Returns:
+ *   number of written bytes or -1 in case of an error
+ *
+ *****************************************************************************/
+int16_t eecache_write (uint8_t* buf, uint16_t offset, uint16_t len)
+{
+    uint16_t done = 0;
+    uint16_t off, n, i;
+    line_t *line;
+
+    if (len > EEPROM_TOTAL_SIZE || offset+len > EEPROM_TOTAL_SIZE) {
+        return -1;
+    }
+
+    osMutexWait(cacheMutex, osWaitForever);
+
+    while (done < len) {
+        off = (offset + done) % EEPROM_PAGE_SIZE;
+        n = MIN(EEPROM_PAGE_SIZE - off, len - done);
+
+        line = getLine((offset + done) / EEPROM_PAGE_SIZE);
+        if (line == NULL) {
+            osMutexRelease(cacheMutex);
+            return -1;
+        }
+
+        for (i = 0; i < n; i++, off++) {
+            if ((line->valid & (1 << off)) && line->data[off] == buf[done + i]) {
+                cacheStats.unchanged++;
+                continue;
+            }
+            line->data[off] = buf[done + i];
+            line->valid |= (1 << off);
+            line->dirty |= (1 << off);
+        }
+        done += n;
+    }
+
+    osMutexRelease(cacheMutex);
+
+    return len;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Write all dirty pages to the EEPROM
+ *
+ * Returns:
+ *   number of page writes or -1 in case of an error
+ *
+ *****************************************************************************/
+int16_t eecache_flush (void)
+{
+    int16_t writes = 0;
+    int i;
+
+    osMutexWait(cacheMutex, osWaitForever);
+
+    for (i = 0; i < EECACHE_LINES; i++) {
+        if (lines[i].dirty == 0) {
+            continue;
+        }
+        if (flushLine(&lines[i]) != 0) {
+            osMutexRelease(cacheMutex);
+            return -1;
+        }
+        writes++;
+    }
+
+    osMutexRelease(cacheMutex);
+
+    return writes;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Start a low priority thread that flushes the cache periodically
+ *
+ * Params:
+ *   [in] periodMs - flush period, 0 for EECACHE_FLUSH_MS
+ *
+ *****************************************************************************/
+void eecache_startFlusher (uint32_t periodMs)
+{
+    flushPeriod = (periodMs != 0) ? periodMs : EECACHE_FLUSH_MS;
+
+    if (flushThread == NULL) {
+        flushThread = osThreadCreate(osThread(eecacheFlushTask), NULL);
+    }
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Get the cache statistics
+ *
+ * Params:
+ *   [out] stats - statistics since eecache_init
+ *
+ *****************************************************************************/
+void eecache_getStats (eecache_stats_t *stats)
+{
+    osMutexWait(cacheMutex, osWaitForever);
+    *stats = cacheStats;
+    osMutexRelease(cacheMutex);
+}
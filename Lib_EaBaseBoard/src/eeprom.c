@@ -8,7 +8,8 @@
 
 /*
  * NOTE: I2C must have been initialized before calling any functions in this
- * file.
+ * file. Every I2C transfer holds the I2C bus lock, so other devices can be
+ * accessed from other threads while an asynchronous write is in progress.
  */
 
 /******************************************************************************
@@ -20,6 +21,8 @@
 #include "i2c.h"
 #include "string.h"
 #include "stdio.h"
+#include "cmsis_os.h"
+#include "ustimer.h"
 #include "eeprom.h"
 
 /******************************************************************************
@@ -35,9 +38,18 @@
 #define EEPROM_I2C_ADDR3    (0x52)
 #define EEPROM_I2C_ADDR4    (0x53)
 
-#define EEPROM_TOTAL_SIZE 1024
 #define EEPROM_BLOCK_SIZE  256
-#define EEPROM_PAGE_SIZE    16
+
+/* Maximum write cycle time from the datasheet. ACK polling gives up after
+   twice this time. */
+#define EEPROM_WRITE_US    5000
+
+/* An address probe takes ~100us at 100 kHz. Only used to bound the
+   polling before the kernel is started, when there is no clock. */
+#define EEPROM_PROBE_US    100
+
+/* sleep between probes when the microsecond timer is running */
+#define EEPROM_POLL_US     500
 
 
 /******************************************************************************
@@ -53,13 +65,134 @@
  * Local Functions
  *****************************************************************************/
 
-static void eepromDelay(void)
+static osThreadId asyncThread = NULL;
+static osThreadId asyncNotify;
+static int32_t asyncSignal;
+static uint8_t* asyncBuf;
+static uint16_t asyncOffset;
+static uint16_t asyncLen;
+static volatile uint8_t asyncBusy = 0;
+static volatile int16_t asyncResult = 0;
+
+osMutexDef(eeprom_async);
+static osMutexId asyncMutex = NULL;
+
+static uint32_t pollCount = 0;
+
+/*
+ * ACK polling: the EEPROM does not acknowledge its address until the
+ * internal write cycle is finished. With the microsecond timer the thread
+ * sleeps between probes, so threads of any priority get the CPU and the
+ * bus is not flooded. Otherwise a kernel tick would be longer than the
+ * write cycle, so the thread only yields, and before the kernel is started
+ * the probes are back to back.
+ *
+ * The timeout is taken from the microsecond timer or from the kernel
+ * system timer. Before the kernel is started neither may run, and the
+ * probes are counted instead.
+ */
+static int eepromWaitReady(uint8_t addr)
 {
-    volatile int i = 0;
+    uint8_t usClock = USTimerRunning();
+    uint8_t kernel = osKernelRunning();
+    uint32_t start = 0;
+    uint32_t probes = 0;
+
+    if (usClock) {
+        start = USTimerNow();
+    }
+    else if (kernel) {
+        start = osKernelSysTick();
+    }
 
-    for (i = 0; i <0x20000; i++);
+    while (1) {
+        pollCount++;
+        probes++;
+        if (I2CProbe(addr << 1)) {
+            return 0;
+        }
+
+        if (usClock) {
+            if (USTimerNow() - start >= 2 * EEPROM_WRITE_US) {
+                return -1;
+            }
+        }
+        else if (kernel) {
+            if (osKernelSysTick() - start
+                >= osKernelSysTickMicroSec(2 * EEPROM_WRITE_US)) {
+                return -1;
+            }
+        }
+        else if (probes >= 2 * EEPROM_WRITE_US / EEPROM_PROBE_US) {
+            return -1;
+        }
+
+        if (kernel) {
+            if (usClock) {
+                osDelayUs(EEPROM_POLL_US);
+            }
+            else {
+                osThreadYield();
+            }
+        }
+    }
 }
 
+static int16_t writePages(uint8_t* buf, uint16_t offset, uint16_t len)
+{
+    uint8_t addr = 0;
+    int16_t written = 0;
+    uint16_t wLen = 0;
+    uint16_t off = offset;
+    uint8_t tmp[17];
+
+    if (len > EEPROM_TOTAL_SIZE || offset+len > EEPROM_TOTAL_SIZE) {
+        return -1;
+    }
+
+    addr = EEPROM_I2C_ADDR1 + (offset/EEPROM_BLOCK_SIZE);
+    off = offset % EEPROM_BLOCK_SIZE;
+    wLen = ((((off >> 4) + 1) << 4) - off);
+    wLen = MIN(wLen, len);
+
+    while (len) {
+        tmp[0] = off;
+        memcpy(&tmp[1], (void*)&buf[written], wLen);
+        I2CWrite((addr << 1), tmp, wLen+1);
+
+        /* wait for the write cycle */
+        if (eepromWaitReady(addr) != 0) {
+            return -1;
+        }
+
+        len     -= wLen;
+        written += wLen;
+        off  += wLen;
+
+        wLen = MIN(EEPROM_PAGE_SIZE, len);
+
+        addr += off / EEPROM_BLOCK_SIZE;
+        off  = off % EEPROM_BLOCK_SIZE;
+    }
+
+    return written;
+}
+
+static void eepromAsyncTask(void const *args)
+{
+    while (1) {
+        osSignalWait(0x01, osWaitForever);
+
+        asyncResult = writePages(asyncBuf, asyncOffset, asyncLen);
+        asyncBusy = 0;
+
+        if (asyncNotify != NULL) {
+            osSignalSet(asyncNotify, asyncSignal);
+        }
+    }
+}
+osThreadDef(eepromAsyncTask, osPriorityBelowNormal, 1, 0);
+
 /******************************************************************************
  * Public Functions
  *****************************************************************************/
@@ -67,12 +200,15 @@ static void eepromDelay(void)
 /******************************************************************************
  *
  * Description:
- *    Initialize the EEPROM Driver
+ *    Initialize the EEPROM Driver. Creates the lock that serializes
+ *    eeprom_writeAsync callers.
  *
  *****************************************************************************/
 void eeprom_init (void)
 {
-
+    if (asyncMutex == NULL) {
+        asyncMutex = osMutexCreate(osMutex(eeprom_async));
+    }
 }
 
 /******************************************************************************
@@ -127,38 +263,97 @@ int16_t eeprom_read(uint8_t* buf, uint16_t offset, uint16_t len)
  *****************************************************************************/
 int16_t eeprom_write(uint8_t* buf, uint16_t offset, uint16_t len)
 {
-    uint8_t addr = 0;
-    int16_t written = 0;
-    uint16_t wLen = 0;
-    uint16_t off = offset;
-    uint8_t tmp[17];
+    return writePages(buf, offset, len);
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Start writing to the EEPROM in the background. Pages are written
+ *    by a low priority thread, the caller is signalled when all pages
+ *    are written. The buffer must not be changed until then.
+ *
+ * Params:
+ *   [in] buf - data to write
+ *   [in] offset - offset to start to write to
+ *   [in] len - number of bytes to write
+ *   [in] thread - thread to signal when done, NULL for none
+ *   [in] signal - signal flags to set
+ *
+ * Returns:
+ *   0 if the write was started, -1 if the arguments are invalid or
+ *   another write is in progress
+ *
+ *****************************************************************************/
+int16_t eeprom_writeAsync(uint8_t* buf, uint16_t offset, uint16_t len,
+                          void *thread, int32_t signal)
+{
+    int16_t result = -1;
 
     if (len > EEPROM_TOTAL_SIZE || offset+len > EEPROM_TOTAL_SIZE) {
         return -1;
     }
 
-    addr = EEPROM_I2C_ADDR1 + (offset/EEPROM_BLOCK_SIZE);
-    off = offset % EEPROM_BLOCK_SIZE;
-    wLen = ((((off >> 4) + 1) << 4) - off);
-    wLen = MIN(wLen, len);
-
-    while (len) {
-        tmp[0] = off;
-        memcpy(&tmp[1], (void*)&buf[written], wLen);
-        I2CWrite((addr << 1), tmp, wLen+1);
+    /* two callers must not both see the writer idle */
+    if (asyncMutex != NULL) {
+        osMutexWait(asyncMutex, osWaitForever);
+    }
 
-        /* delay to wait for a write cycle */
-        eepromDelay();
+    if (!asyncBusy && asyncThread == NULL) {
+        asyncThread = osThreadCreate(osThread(eepromAsyncTask), NULL);
+    }
 
-        len     -= wLen;
-        written += wLen;
-        off  += wLen;
+    if (!asyncBusy && asyncThread != NULL) {
+        asyncBuf = buf;
+        asyncOffset = offset;
+        asyncLen = len;
+        asyncNotify = (osThreadId)thread;
+        asyncSignal = signal;
+        asyncBusy = 1;
 
-        wLen = MIN(EEPROM_PAGE_SIZE, len);
+        osSignalSet(asyncThread, 0x01);
+        result = 0;
+    }
 
-        addr += off / EEPROM_BLOCK_SIZE;
-        off  = off % EEPROM_BLOCK_SIZE;
+    if (asyncMutex != NULL) {
+        osMutexRelease(asyncMutex);
     }
 
-    return written;
+    return result;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Check if an asynchronous write is in progress
+ *
+ *****************************************************************************/
+uint8_t eeprom_writeBusy(void)
+{
+    return asyncBusy;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Result of the last asynchronous write
+ *
+ * Returns:
+ *   number of written bytes or -1 in case of an error
+ *
+ *****************************************************************************/
+int16_t eeprom_writeResult(void)
+{
+    return asyncResult;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Number of address probes done while waiting for write cycles
+ *
+ *****************************************************************************/
+uint32_t eeprom_getPollCount(void)
+{
+    return pollCount;
 }
@@ -8,8 +8,14 @@
 
 /*
  * NOTE: SPI must have been initialized before calling any functions in
- * this file.
+ * this file. flash_writeAsync also needs a running RTX kernel and
+ * USTimerInit.
  *
+ * Pages are written through the two SRAM buffers of the AT45, using them
+ * alternately: the next page is clocked into one buffer while the device
+ * programs the previous page from the other, so the SPI transfer overlaps
+ * the program time. A partial page is first loaded into its buffer from
+ * main memory so the rest of the page is preserved.
  */
 
 /******************************************************************************
@@ -20,6 +26,8 @@
 #include "type.h"
 #include "gpio.h"
 #include "ssp.h"
+#include "cmsis_os.h"
+#include "ustimer.h"
 #include "flash.h"
 
 /******************************************************************************
@@ -30,8 +38,9 @@
 #define MIN(x, y) ((x) < (y) ? (x) : (y))
 #endif
 
-#define FLASH_CS_OFF() GPIOSetValue( PORT1, 11, 1 )
-#define FLASH_CS_ON()  GPIOSetValue( PORT1, 11, 0 )
+/* the SSP port is locked while CS is asserted */
+#define FLASH_CS_OFF() do { GPIOPinSet( GPIO_PIN( PORT1, 11 ) ); SSPUnlock(); } while (0)
+#define FLASH_CS_ON()  do { SSPLock(); SSPSelect( SSP_CLIENT_FLASH ); GPIOPinClear( GPIO_PIN( PORT1, 11 ) ); } while (0)
 
 
 #define FLASH_CMD_RDID      0x9F        /* read device ID */
@@ -43,6 +52,13 @@
 #define FLASH_CMD_PE        0x81        /* page erase */
 #define FLASH_CMD_PP_BUF    0x82        /* page program through buffer 1 */
 
+#define FLASH_CMD_BUF1_WR   0x84        /* buffer 1 write */
+#define FLASH_CMD_BUF2_WR   0x87        /* buffer 2 write */
+#define FLASH_CMD_BUF1_LD   0x53        /* main memory page to buffer 1 */
+#define FLASH_CMD_BUF2_LD   0x55        /* main memory page to buffer 2 */
+#define FLASH_CMD_BUF1_PP   0x83        /* buffer 1 to page, with erase */
+#define FLASH_CMD_BUF2_PP   0x86        /* buffer 2 to page, with erase */
+
 #define FLASH_CMD_DP        0xB9        /* deep power down */
 #define FLASH_CMD_RES       0xAB        /* release from deep power down */
 
@@ -60,6 +76,8 @@
 
 #define FLAG_IS_POW2 0x01
 
+#define FLASH_POLL_US   500     /* status poll period of the async writer */
+
 struct _flash_info
 {
     char* name;
@@ -85,6 +103,20 @@ static uint8_t  pageIsPow2 = 0;
 static uint8_t  pageSizeChanged = FALSE;
 static uint32_t flashTotalSize = 0;
 
+static uint8_t  curBuf = 0;
+
+static osThreadId asyncThread = NULL;
+static osThreadId asyncNotify;
+static int32_t asyncSignal;
+static uint8_t* asyncBuf;
+static uint32_t asyncOffset;
+static uint32_t asyncLen;
+static volatile uint8_t asyncBusy = 0;
+static volatile uint32_t asyncResult = 0;
+
+osMutexDef(flash_async);
+static osMutexId asyncMutex = NULL;
+
 static struct _flash_info flash_devices[] = {
         {"AT45DB081D", 0x1F2500, 4096, 264, 9, 0},
         {"AT45DB081D", 0x1F2500, 4096, 256, 8, FLAG_IS_POW2},
@@ -134,18 +166,35 @@ static uint8_t readStatus(void)
 }
 
 
-static void pollIsBusy(void)
+/*
+ * Wait until the device is ready. The async writer sleeps between polls,
+ * for one tick if the microsecond timer was not started. A blocking
+ * caller lets other threads run if the kernel is running.
+ */
+static void pollIsBusy(uint8_t sleep)
 {
-  uint8_t status = 0;
-  int i = 0;
-
-  do
-  {
-    for (i = 0; i < 0x2000; i++);
+    while ((readStatus() & STATUS_RDY) == 0) {
+        if (sleep && USTimerRunning()) {
+            osDelayUs(FLASH_POLL_US);
+        }
+        else if (sleep) {
+            osDelay(1);
+        }
+        else if (osKernelRunning()) {
+            osThreadYield();
+        }
+    }
+}
 
-    status = readStatus();
-  }
-  while ((status & STATUS_RDY) == 0);
+/*
+ * Blocking reads and writes wait for a background write to finish. It
+ * only runs in a thread, so the kernel is running whenever it is busy.
+ */
+static void waitAsync(void)
+{
+    while (asyncBusy) {
+        osDelay(1);
+    }
 }
 
 static void setAddressBytes(uint8_t* addr, uint32_t offset)
@@ -156,7 +205,7 @@ static void setAddressBytes(uint8_t* addr, uint32_t offset)
 
         /* buffer address bits */
         addr[2] = (off & 0xff);
-        addr[1] = (off / pageSize);
+        addr[1] = (off >> 8);
 
         /* page address bits */
         addr[1] |= ((page & ((1 << (16-pageOffset))-1)) << (pageOffset-8));
@@ -171,6 +220,88 @@ static void setAddressBytes(uint8_t* addr, uint32_t offset)
     }
 }
 
+static void bufferCommand(uint8_t cmd, uint32_t offset)
+{
+    uint8_t addr[4];
+
+    addr[0] = cmd;
+    setAddressBytes(&addr[1], offset);
+
+    FLASH_CS_ON();
+    SSPSend(addr, 4);
+    FLASH_CS_OFF();
+}
+
+static void bufferWrite(uint8_t buffer, uint32_t offset, uint8_t* buf,
+                        uint16_t len)
+{
+    uint8_t addr[4];
+
+    addr[0] = (buffer == 0) ? FLASH_CMD_BUF1_WR : FLASH_CMD_BUF2_WR;
+    setAddressBytes(&addr[1], offset);
+
+    FLASH_CS_ON();
+    SSPSend(addr, 4);
+    SSPSend(buf, len);
+    FLASH_CS_OFF();
+}
+
+static uint32_t writePages(uint8_t* buf, uint32_t offset, uint32_t len,
+                           uint8_t sleep)
+{
+    uint16_t wLen;
+    uint32_t written = 0;
+    uint32_t page;
+
+    /* write up to first page boundry */
+    wLen = pageSize - (offset%pageSize);
+    wLen = MIN(wLen, len);
+
+    while (len) {
+        page = offset - (offset%pageSize);
+        curBuf ^= 1;
+
+        if (wLen != pageSize) {
+            /* keep the rest of the page */
+            pollIsBusy(sleep);
+            bufferCommand((curBuf == 0) ? FLASH_CMD_BUF1_LD : FLASH_CMD_BUF2_LD,
+                          page);
+            pollIsBusy(sleep);
+        }
+
+        /* the other buffer may still be programming */
+        bufferWrite(curBuf, offset, &buf[written], wLen);
+
+        pollIsBusy(sleep);
+        bufferCommand((curBuf == 0) ? FLASH_CMD_BUF1_PP : FLASH_CMD_BUF2_PP,
+                      page);
+
+        len     -= wLen;
+        written += wLen;
+        offset  += wLen;
+        wLen = MIN(pageSize, len);
+    }
+
+    pollIsBusy(sleep);
+
+    return written;
+}
+
+static void flashAsyncTask(void const *args)
+{
+    while (1) {
+        osSignalWait(0x01, osWaitForever);
+
+        asyncResult = writePages(asyncBuf, asyncOffset, asyncLen, TRUE);
+        asyncBusy = 0;
+
+        if (asyncNotify != NULL) {
+            osSignalSet(asyncNotify, asyncSignal);
+        }
+    }
+}
+osThreadDef(flashAsyncTask, osPriorityNormal, 1, 0);
+
 /******************************************************************************
  * Public Functions
  *****************************************************************************/
@@ -193,14 +324,17 @@ uint32_t flash_init (void)
     int i = 0;
 
     GPIOSetDir( PORT1, 11, 1 );
-    FLASH_CS_OFF();
+    GPIOPinSet( GPIO_PIN( PORT1, 11 ) );
+
+    if (asyncMutex == NULL) {
+        asyncMutex = osMutexCreate(osMutex(flash_async));
+    }
 
     exitDeepPowerDown();
     readDeviceId(deviceId);
 
-    do {
-        status = readStatus();
-    } while ((status & STATUS_RDY) == 0);
+    pollIsBusy(FALSE);
+    status = readStatus();
 
     if ((status & STATUS_POW2) != 0)
     {
@@ -230,7 +364,7 @@ uint32_t flash_init (void)
 /******************************************************************************
  *
  * Description:
- *    Write data to flash
+ *    Write data to flash. Waits for a background write to finish first.
  *
  * Params:
  *   [in] buf - data to write to flash
@@ -243,10 +377,6 @@ uint32_t flash_init (void)
  *****************************************************************************/
 uint32_t flash_write(uint8_t* buf, uint32_t offset, uint32_t len)
 {
-    uint16_t wLen;
-    uint32_t written = 0;
-    uint8_t addr[4];
-
     if (len > flashTotalSize || len+offset > flashTotalSize) {
         return 0;
     }
@@ -255,44 +385,101 @@ uint32_t flash_write(uint8_t* buf, uint32_t offset, uint32_t len)
         return 0;
     }
 
-    /* write up to first page boundry */
-    wLen = (((( (offset%pageSize) / pageSize) + 1) * pageSize)
-            - (offset%pageSize));
-    wLen = MIN(wLen, len);
+    waitAsync();
 
-    while (len) {
+    return writePages(buf, offset, len, FALSE);
+}
 
-        /* write address */
-        addr[0] = FLASH_CMD_PP_BUF;
-        setAddressBytes(&addr[1], offset);
+/******************************************************************************
+ *
+ * Description:
+ *    Start writing data to flash in the background. A thread clocks the
+ *    pages into the SRAM buffers and sleeps while they are programmed.
+ *    The caller is signalled when all pages are written. The buffer must
+ *    not be changed until then.
+ *
+ * Params:
+ *   [in] buf - data to write to flash
+ *   [in] offset - offset into the flash
+ *   [in] len - number of bytes to write
+ *   [in] thread - thread to signal when done, NULL for none
+ *   [in] signal - signal flags to set
+ *
+ * Returns:
+ *   TRUE if the write was started, FALSE if the arguments are invalid or
+ *   another write is in progress
+ *
+ *****************************************************************************/
+uint32_t flash_writeAsync(uint8_t* buf, uint32_t offset, uint32_t len,
+                          void *thread, int32_t signal)
+{
+    uint32_t started = FALSE;
 
-        FLASH_CS_ON();
+    if (len > flashTotalSize || len+offset > flashTotalSize) {
+        return FALSE;
+    }
 
-        SSPSend(addr, 4);
+    if (pageSizeChanged) {
+        return FALSE;
+    }
 
-        /* write data */
-        SSPSend(&buf[written], wLen);
+    /* two callers must not both see the writer idle */
+    if (asyncMutex != NULL) {
+        osMutexWait(asyncMutex, osWaitForever);
+    }
 
-        FLASH_CS_OFF();
+    if (!asyncBusy && asyncThread == NULL) {
+        asyncThread = osThreadCreate(osThread(flashAsyncTask), NULL);
+    }
 
-        /* delay to wait for a write cycle */
-        //eepromDelay();
+    if (!asyncBusy && asyncThread != NULL) {
+        asyncBuf = buf;
+        asyncOffset = offset;
+        asyncLen = len;
+        asyncNotify = (osThreadId)thread;
+        asyncSignal = signal;
+        asyncBusy = 1;
 
-        len     -= wLen;
-        written += wLen;
-        offset  += wLen;
-        wLen = MIN(pageSize, len);
+        osSignalSet(asyncThread, 0x01);
+        started = TRUE;
+    }
 
-        pollIsBusy();
+    if (asyncMutex != NULL) {
+        osMutexRelease(asyncMutex);
     }
 
-    return written;
+    return started;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Check if an asynchronous write is in progress
+ *
+ *****************************************************************************/
+uint8_t flash_isBusy(void)
+{
+    return asyncBusy;
 }
 
 /******************************************************************************
  *
  * Description:
- *    Read data from flash
+ *    Result of the last asynchronous write
+ *
+ * Returns:
+ *   number of written bytes
+ *
+ *****************************************************************************/
+uint32_t flash_writeResult(void)
+{
+    return asyncResult;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Read data from flash. Waits for a background write to finish first.
  *
  * Params:
  *   [in] buf - data buffer
@@ -315,6 +502,8 @@ uint32_t flash_read(uint8_t* buf, uint32_t offset, uint32_t len)
         return 0;
     }
 
+    waitAsync();
+
     addr[0] = FLASH_CMD_FAST_READ;
 
     setAddressBytes(&addr[1], offset);
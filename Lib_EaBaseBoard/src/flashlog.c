@@ -0,0 +1,415 @@
+/*****************************************************************************
+ *   flashlog.c:  Append-only record log on the SPI flash
+ *
+ ******************************************************************************/
+
+/*
+ * NOTE: flash_init must have been called before flashlog_mount. The log
+ * is meant to be used from a single thread.
+ *
+ * The log area is used as a ring of pages. Each page starts with a header
+ * holding a magic number and a sequence number that grows by one for
+ * every new page, followed by records: a length byte, the data and a
+ * CRC16 of both. The first erased byte (0xFF) ends the records of a page.
+ *
+ * Records are appended to a RAM copy of the head page, which is programmed
+ * when it is full or on flashlog_sync. Pages are always programmed whole,
+ * so no read-modify-write is needed, and the rotation programs every page
+ * of the area in turn, which spreads the wear evenly. When the ring is
+ * full the oldest page is overwritten.
+ *
+ * The sequence numbers along the area are s0, s0+1, ... up to the head
+ * page, so the head is found with a binary search over the page headers.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "mcu_regs.h"
+#include "type.h"
+#include "string.h"
+#include "flashlog.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+
+#define LOG_MAGIC   0x4C46      /* "FL" */
+#define ERASED      0xFF
+
+/******************************************************************************
+ * External global variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+static uint32_t firstPage = 0;
+static uint32_t numPages = 0;
+static uint16_t pageSize = 0;
+
+static uint32_t headPage = 0;
+static uint32_t headSeq = 0;
+static uint16_t headFill = 0;
+static uint8_t  headDirty = 0;
+static uint8_t  head[FLASHLOG_MAX_PAGE];
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+static uint16_t crc16(uint16_t crc, uint8_t* data, uint16_t len)
+{
+    int i;
+
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static uint32_t pageAddr(uint32_t page)
+{
+    return (firstPage + page) * pageSize;
+}
+
+static uint8_t readHeader(uint32_t page, uint32_t *seq)
+{
+    uint8_t hdr[FLASHLOG_HDR_SIZE];
+
+    flash_read(hdr, pageAddr(page), FLASHLOG_HDR_SIZE);
+
+    if ((hdr[0] | hdr[1] << 8) != LOG_MAGIC
+        || (hdr[6] | hdr[7] << 8) != crc16(0xFFFF, hdr, 6)) {
+        return FALSE;
+    }
+    *seq = hdr[2] | hdr[3] << 8 | hdr[4] << 16 | (uint32_t)hdr[5] << 24;
+
+    return TRUE;
+}
+
+/* true for the pages written in order from page 0, up to the head */
+static uint8_t inFirstRun(uint32_t page, uint32_t seq0)
+{
+    uint32_t seq;
+
+    return readHeader(page, &seq) && seq == seq0 + page;
+}
+
+static void openNextPage(void)
+{
+    uint16_t crc;
+
+    headPage = (headPage + 1) % numPages;
+    headSeq++;
+
+    memset(head, ERASED, pageSize);
+    head[0] = LOG_MAGIC & 0xFF;
+    head[1] = LOG_MAGIC >> 8;
+    head[2] = headSeq;
+    head[3] = headSeq >> 8;
+    head[4] = headSeq >> 16;
+    head[5] = headSeq >> 24;
+    crc = crc16(0xFFFF, head, 6);
+    head[6] = crc & 0xFF;
+    head[7] = crc >> 8;
+
+    headFill = FLASHLOG_HDR_SIZE;
+    headDirty = 0;
+}
+
+/*
+ * Find the head by reading every header, for when page 0 is unreadable
+ * and the binary search has no starting point. The head is the page with
+ * the highest sequence number.
+ */
+static uint8_t scanForHead(void)
+{
+    uint32_t page;
+    uint32_t seq;
+    uint8_t found = FALSE;
+
+    for (page = 1; page < numPages; page++) {
+        if (readHeader(page, &seq) && (!found || seq > headSeq)) {
+            headPage = page;
+            headSeq = seq;
+            found = TRUE;
+        }
+    }
+
+    return found;
+}
+
+/* offset after the last valid record of a page image */
+static uint16_t scanRecords(uint8_t* page)
+{
+    uint16_t off = FLASHLOG_HDR_SIZE;
+
+    while (off < pageSize && page[off] != ERASED
+           && off + page[off] + FLASHLOG_REC_OVH <= pageSize) {
+        off += page[off] + FLASHLOG_REC_OVH;
+    }
+
+    return off;
+}
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * Description:
+ *    Mount the log. The head page is found by a binary search over the
+ *    page headers and loaded so appending continues after its last
+ *    record. If the header of page 0 is not valid all the other headers
+ *    are read; only an area without any valid header gives an empty log.
+ *
+ * Params:
+ *   [in] first - first flash page of the log area
+ *   [in] count - number of pages in the log area, at least 2
+ *
+ * Returns:
+ *   TRUE if successful, FALSE if the area or page size is not supported
+ *
+ *****************************************************************************/
+uint32_t flashlog_mount (uint32_t first, uint32_t count)
+{
+    uint32_t seq0;
+    uint32_t lo, hi, mid;
+
+    pageSize = flash_getPageSize();
+    if (pageSize == 0 || pageSize > FLASHLOG_MAX_PAGE || count < 2) {
+        return FALSE;
+    }
+
+    firstPage = first;
+    numPages = count;
+
+    if (readHeader(0, &seq0)) {
+        lo = 0;
+        hi = numPages - 1;
+        while (lo < hi) {
+            mid = (lo + hi + 1) / 2;
+            if (inFirstRun(mid, seq0)) {
+                lo = mid;
+            }
+            else {
+                hi = mid - 1;
+            }
+        }
+
+        headPage = lo;
+        headSeq = seq0 + lo;
+    }
+    else if (!scanForHead()) {
+        /* blank, the first page gets sequence number 1 */
+        headPage = numPages - 1;
+        headSeq = 0;
+        openNextPage();
+        return TRUE;
+    }
+
+    flash_read(head, pageAddr(headPage), pageSize);
+    headFill = scanRecords(head);
+    headDirty = 0;
+
+    return TRUE;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Append a record. The record is copied to the RAM image of the head
+ *    page; the flash is only programmed when the page is full.
+ *
+ * Params:
+ *   [in] data - record data
+ *   [in] len - record length
+ *
+ * Returns:
+ *   len or -1 if the record does not fit in a page or the full head page
+ *   could not be programmed
+ *
+ *****************************************************************************/
+int16_t flashlog_append (void* data, uint8_t len)
+{
+    uint16_t crc;
+
+    if (len == 0 || len == ERASED
+        || FLASHLOG_HDR_SIZE + len + FLASHLOG_REC_OVH > pageSize) {
+        return -1;
+    }
+
+    if (headFill + len + FLASHLOG_REC_OVH > pageSize) {
+        if (!flashlog_sync()) {
+            return -1;
+        }
+        openNextPage();
+    }
+
+    head[headFill] = len;
+    memcpy(&head[headFill + 1], data, len);
+    crc = crc16(0xFFFF, &head[headFill], len + 1);
+    head[headFill + len + 1] = crc & 0xFF;
+    head[headFill + len + 2] = crc >> 8;
+
+    headFill += len + FLASHLOG_REC_OVH;
+    headDirty = 1;
+
+    return len;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Program the head page if it holds records not written yet. Later
+ *    appends to the same page program it again.
+ *
+ * Returns:
+ *   TRUE if successful, FALSE if the page could not be written. The
+ *   records stay in RAM and the next sync tries again.
+ *
+ *****************************************************************************/
+uint32_t flashlog_sync (void)
+{
+    if (headDirty) {
+        if (flash_write(head, pageAddr(headPage), pageSize) != pageSize) {
+            return FALSE;
+        }
+        headDirty = 0;
+    }
+
+    return TRUE;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Position a cursor at the oldest record
+ *
+ * Params:
+ *   [out] cursor - cursor for flashlog_next
+ *
+ *****************************************************************************/
+void flashlog_rewind (flashlog_cursor_t *cursor)
+{
+    uint32_t tail = (headPage + 1) % numPages;
+    uint32_t seq;
+
+    cursor->offset = FLASHLOG_HDR_SIZE;
+    cursor->done = 0;
+
+    /* after a wrap the page after the head is the oldest one */
+    if (headSeq >= numPages && readHeader(tail, &seq)
+        && seq == headSeq - numPages + 1) {
+        cursor->page = tail;
+        cursor->seq = seq;
+    }
+    else {
+        cursor->page = 0;
+        cursor->seq = headSeq - headPage;
+        if (cursor->seq != headSeq
+            && (!readHeader(0, &seq) || seq != cursor->seq)) {
+            cursor->done = 1;
+        }
+    }
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Read the next record
+ *
+ * Params:
+ *   [in] cursor - cursor from flashlog_rewind
+ *   [out] buf - record data
+ *   [in] len - size of buf
+ *
+ * Returns:
+ *   record length, 0 at the end of the log or -1 if the record is
+ *   corrupt or larger than buf. The cursor moves past the record in all
+ *   cases.
+ *
+ *****************************************************************************/
+int16_t flashlog_next (flashlog_cursor_t *cursor, void* buf, uint8_t len)
+{
+    uint8_t rec[2];
+    uint8_t recLen;
+    uint16_t crc;
+    uint32_t seq;
+    uint32_t addr;
+
+    while (!cursor->done) {
+
+        if (cursor->seq == headSeq) {
+            /* head page, read from the RAM image */
+            if (cursor->offset >= headFill) {
+                cursor->done = 1;
+                break;
+            }
+            recLen = head[cursor->offset];
+            crc = head[cursor->offset + recLen + 1]
+                | head[cursor->offset + recLen + 2] << 8;
+            cursor->offset += recLen + FLASHLOG_REC_OVH;
+
+            if (recLen > len
+                || crc != crc16(0xFFFF, &head[cursor->offset - recLen - 3],
+                                recLen + 1)) {
+                return -1;
+            }
+            memcpy(buf, &head[cursor->offset - recLen - 2], recLen);
+            return recLen;
+        }
+
+        addr = pageAddr(cursor->page) + cursor->offset;
+        recLen = ERASED;
+        if (cursor->offset < pageSize) {
+            flash_read(&recLen, addr, 1);
+        }
+        if (recLen == ERASED
+            || cursor->offset + recLen + FLASHLOG_REC_OVH > pageSize) {
+            /* end of this page, the next one must follow in sequence */
+            cursor->page = (cursor->page + 1) % numPages;
+            cursor->seq++;
+            cursor->offset = FLASHLOG_HDR_SIZE;
+            if (cursor->seq != headSeq
+                && (!readHeader(cursor->page, &seq) || seq != cursor->seq)) {
+                cursor->done = 1;
+            }
+            continue;
+        }
+
+        cursor->offset += recLen + FLASHLOG_REC_OVH;
+        if (recLen > len) {
+            return -1;
+        }
+
+        flash_read(buf, addr + 1, recLen);
+        flash_read(rec, addr + 1 + recLen, 2);
+        crc = crc16(crc16(0xFFFF, &recLen, 1), buf, recLen);
+        if (crc != (rec[0] | rec[1] << 8)) {
+            return -1;
+        }
+        return recLen;
+    }
+
+    return 0;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Sequence number of the head page
+ *
+ *****************************************************************************/
+uint32_t flashlog_getSeq (void)
+{
+    return headSeq;
+}
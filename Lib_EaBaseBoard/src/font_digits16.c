@@ -0,0 +1,71 @@
+/* Generated by bdf2font from Tools/bdf2font/digits16.bdf - do not edit */
+#include "type.h"
+#include "font.h"
+
+static const uint8_t digits16_width[] =
+{
+     4,  0,  0,  0,  0, 11,  0,  0,  0,  0,  0, 10,  0,  8,  4,  0,
+    11,  8, 11, 11, 11, 11, 11, 11, 11, 11,  4,
+};
+
+static const uint16_t digits16_offset[] =
+{
+       0,    8,    8,    8,    8,    8,   30,   30,   30,   30,   30,   30,
+      50,   50,   66,   74,   74,   96,  112,  134,  156,  178,  200,  222,
+     244,  266,  288,
+};
+
+static const uint8_t digits16_bits[] =
+{
+    /* ' ' */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* '%' */
+    0x0C, 0x40, 0x12, 0x70, 0x12, 0x3C, 0x0C, 0x0F, 0xC0, 0x03, 0xF0, 0x30,
+    0x3C, 0x48, 0x0E, 0x48, 0x02, 0x30, 0x00, 0x00, 0x00, 0x00,
+    /* '+' */
+    0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0xF0, 0x0F, 0xF0, 0x0F, 0x80, 0x01,
+    0x80, 0x01, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00,
+    /* '-' */
+    0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01,
+    0x00, 0x00, 0x00, 0x00,
+    /* '.' */
+    0x00, 0x60, 0x00, 0x60, 0x00, 0x00, 0x00, 0x00,
+    /* '0' */
+    0xF8, 0x1F, 0xFC, 0x3F, 0x06, 0x66, 0x06, 0x63, 0x86, 0x61, 0xC6, 0x60,
+    0x66, 0x60, 0xFC, 0x3F, 0xF8, 0x1F, 0x00, 0x00, 0x00, 0x00,
+    /* '1' */
+    0x08, 0x60, 0x0C, 0x60, 0xFE, 0x7F, 0xFE, 0x7F, 0x00, 0x60, 0x00, 0x60,
+    0x00, 0x00, 0x00, 0x00,
+    /* '2' */
+    0x08, 0x70, 0x0C, 0x78, 0x06, 0x6C, 0x06, 0x66, 0x06, 0x63, 0x86, 0x61,
+    0xC6, 0x60, 0x7C, 0x60, 0x38, 0x60, 0x00, 0x00, 0x00, 0x00,
+    /* '3' */
+    0x04, 0x10, 0x06, 0x30, 0xC6, 0x60, 0xC6, 0x60, 0xC6, 0x60, 0xC6, 0x60,
+    0xE6, 0x60, 0xBE, 0x3F, 0x1C, 0x1F, 0x00, 0x00, 0x00, 0x00,
+    /* '4' */
+    0xC0, 0x03, 0xE0, 0x03, 0x30, 0x03, 0x18, 0x03, 0x0C, 0x03, 0x06, 0x03,
+    0xFE, 0x7F, 0xFE, 0x7F, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00,
+    /* '5' */
+    0xFE, 0x10, 0xFE, 0x30, 0xC6, 0x60, 0xC6, 0x60, 0xC6, 0x60, 0xC6, 0x60,
+    0xC6, 0x60, 0x86, 0x3F, 0x06, 0x1F, 0x00, 0x00, 0x00, 0x00,
+    /* '6' */
+    0xF0, 0x1F, 0xF8, 0x3F, 0x8C, 0x61, 0xC6, 0x60, 0xC2, 0x60, 0xC2, 0x60,
+    0xC2, 0x60, 0x80, 0x3F, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00,
+    /* '7' */
+    0x06, 0x00, 0x06, 0x00, 0x06, 0x00, 0x06, 0x7C, 0x06, 0x7F, 0xC6, 0x03,
+    0xF6, 0x00, 0x3E, 0x00, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* '8' */
+    0x38, 0x1E, 0x7C, 0x3F, 0xC6, 0x61, 0x86, 0x61, 0x86, 0x61, 0x86, 0x61,
+    0xC6, 0x61, 0x7C, 0x3F, 0x38, 0x1E, 0x00, 0x00, 0x00, 0x00,
+    /* '9' */
+    0xF8, 0x00, 0xFC, 0x01, 0x06, 0x43, 0x06, 0x43, 0x06, 0x43, 0x06, 0x63,
+    0x86, 0x31, 0xFC, 0x1F, 0xF8, 0x0F, 0x00, 0x00, 0x00, 0x00,
+    /* ':' */
+    0x30, 0x18, 0x30, 0x18, 0x00, 0x00, 0x00, 0x00,
+};
+
+const font_t font_digits16 =
+{
+    16, 0x20, 0x3A,
+    digits16_width, digits16_offset, digits16_bits
+};
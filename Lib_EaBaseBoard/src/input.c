@@ -0,0 +1,266 @@
+/*****************************************************************************
+ *   input.c:  Interrupt driven input events for the joystick and the
+ *             rotary switch
+ *
+ ******************************************************************************/
+
+/*
+ * NOTE: GPIOInit must have been called before using any functions in this
+ * file. The pin interrupts are installed with GPIOAttachIrq, so the
+ * application must not provide its own PIOINTx handlers.
+ *
+ * Joystick: the first edge on any joystick pin masks the joystick
+ * interrupts and wakes the debounce thread. After the debounce window the
+ * thread samples the pins, reports every direction that changed and
+ * unmasks the interrupts again.
+ *
+ * Rotary: both encoder pins interrupt on both edges and the Gray code is
+ * decoded in the interrupt. Contact bounce toggles between two adjacent
+ * states, so the quarter steps cancel and no time based filter is needed.
+ * A step is reported when the encoder reaches its rest state.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "mcu_regs.h"
+#include "type.h"
+#include "gpio.h"
+#include "cmsis_os.h"
+#include "input.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+
+#define JOYSTICK_PORT   PORT2
+#define JOYSTICK_MASK   0x0F        /* P2.0 - P2.3 */
+
+/* LEFT is wired as in joystick_read */
+#if defined (MCU_LPC1114)
+#define JOYSTICK_LEFT_PORT  PORT3
+#else
+#define JOYSTICK_LEFT_PORT  PORT2
+#endif
+#define JOYSTICK_LEFT_PIN   4
+
+#define ROTARY_PORT     PORT1       /* P1.0 and P1.1 */
+#define ROTARY_REST     0x03
+
+#define SIG_JOYSTICK    0x01
+
+/******************************************************************************
+ * External global variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+static uint32_t (*getTicks)(void) = NULL;
+static uint32_t debounce = INPUT_DEBOUNCE_MS;
+static volatile uint32_t dropped = 0;
+
+static osThreadId debounceThread = NULL;
+static volatile uint32_t joystickTime = 0;
+static uint8_t joystickState = 0;
+
+static uint8_t rotaryState = ROTARY_REST;
+static int8_t rotarySteps = 0;
+
+/*
+ * Quarter step for (previous state << 2 | new state). The sequence
+ * 3-2-0-1-3 is one step to the right, 3-1-0-2-3 one step to the left.
+ */
+static const int8_t rotaryTable[16] = {
+     0, +1, -1,  0,
+    -1,  0,  0, +1,
+    +1,  0,  0, -1,
+     0, -1, +1,  0
+};
+
+osMailQDef(input_mail, INPUT_QUEUE_LEN, input_event_t);
+static osMailQId inputMail = NULL;
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+static uint32_t now(void)
+{
+    return (getTicks != NULL) ? getTicks() : 0;
+}
+
+/* may be called from interrupt context, never blocks */
+static void postEvent(uint8_t type, uint8_t code, uint32_t time)
+{
+    input_event_t *ev = (input_event_t*)osMailAlloc(inputMail, 0);
+
+    if (ev == NULL) {
+        dropped++;
+        return;
+    }
+    ev->type = type;
+    ev->code = code;
+    ev->time = time;
+    osMailPut(inputMail, ev);
+}
+
+static void joystickIrq(uint32_t port, uint32_t pin, void *arg)
+{
+    /* mask until the debounce thread has sampled the pins */
+    GPIO_PORT(JOYSTICK_PORT)->IE &= ~JOYSTICK_MASK;
+    GPIO_PORT(JOYSTICK_LEFT_PORT)->IE &= ~(0x1 << JOYSTICK_LEFT_PIN);
+    joystickTime = now();
+    osSignalSet(debounceThread, SIG_JOYSTICK);
+}
+
+static void rotaryIrq(uint32_t port, uint32_t pin, void *arg)
+{
+    uint8_t state = LPC_GPIO1->MASKED_ACCESS[0x03];
+
+    rotarySteps += rotaryTable[(rotaryState << 2) | state];
+    rotaryState = state;
+
+    if (state != ROTARY_REST) {
+        return;
+    }
+    /* a full detent is four quarter steps, accept a missed one */
+    if (rotarySteps >= 3) {
+        postEvent(INPUT_ROTARY, ROTARY_RIGHT, now());
+    }
+    else if (rotarySteps <= -3) {
+        postEvent(INPUT_ROTARY, ROTARY_LEFT, now());
+    }
+    rotarySteps = 0;
+}
+
+static void inputDebounceTask(void const *args)
+{
+    uint32_t primask;
+    uint8_t state;
+    uint8_t changed;
+    uint8_t bit;
+
+    while (1) {
+        osSignalWait(SIG_JOYSTICK, osWaitForever);
+        osDelay(debounce);
+
+        state = joystick_read();
+        changed = state ^ joystickState;
+        joystickState = state;
+
+        for (bit = JOYSTICK_CENTER; bit <= JOYSTICK_RIGHT; bit <<= 1) {
+            if (changed & bit) {
+                postEvent((state & bit) ? INPUT_JOYSTICK_PRESS : INPUT_JOYSTICK_RELEASE,
+                          bit, joystickTime);
+            }
+        }
+
+        /* IE is also changed by the pin interrupts */
+        primask = __get_PRIMASK();
+        __disable_irq();
+        GPIO_PORT(JOYSTICK_PORT)->IC = JOYSTICK_MASK;
+        GPIO_PORT(JOYSTICK_PORT)->IE |= JOYSTICK_MASK;
+        GPIO_PORT(JOYSTICK_LEFT_PORT)->IC = (0x1 << JOYSTICK_LEFT_PIN);
+        GPIO_PORT(JOYSTICK_LEFT_PORT)->IE |= (0x1 << JOYSTICK_LEFT_PIN);
+        __set_PRIMASK(primask);
+    }
+}
+osThreadDef(inputDebounceTask, osPriorityAboveNormal, 1, 0);
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * Description:
+ *    Initialize the input event engine. Configures the joystick and the
+ *    rotary switch pins, installs their interrupts and starts the debounce
+ *    thread.
+ *
+ * Params:
+ *    [in] getMsTicks - callback used to time stamp the events, may be NULL
+ *    [in] debounceMs - joystick debounce window in ms, 0 for the default
+ *
+ *****************************************************************************/
+void input_init (uint32_t (*getMsTicks)(void), uint32_t debounceMs)
+{
+    uint32_t pin;
+
+    getTicks = getMsTicks;
+    input_setDebounce(debounceMs);
+
+    if (inputMail == NULL) {
+        inputMail = osMailCreate(osMailQ(input_mail), NULL);
+        debounceThread = osThreadCreate(osThread(inputDebounceTask), NULL);
+    }
+
+    joystick_init();
+    rotary_init();
+    joystickState = joystick_read();
+    rotaryState = LPC_GPIO1->MASKED_ACCESS[0x03];
+    rotarySteps = 0;
+
+    for (pin = 0; pin < 4; pin++) {
+        GPIOAttachIrq(JOYSTICK_PORT, pin, GPIO_EDGE_BOTH, joystickIrq, NULL);
+    }
+    GPIOAttachIrq(JOYSTICK_LEFT_PORT, JOYSTICK_LEFT_PIN, GPIO_EDGE_BOTH,
+                  joystickIrq, NULL);
+    GPIOAttachIrq(ROTARY_PORT, 0, GPIO_EDGE_BOTH, rotaryIrq, NULL);
+    GPIOAttachIrq(ROTARY_PORT, 1, GPIO_EDGE_BOTH, rotaryIrq, NULL);
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Change the joystick debounce window
+ *
+ * Params:
+ *    [in] debounceMs - window in ms, 0 for the default
+ *
+ *****************************************************************************/
+void input_setDebounce (uint32_t debounceMs)
+{
+    debounce = (debounceMs != 0) ? debounceMs : INPUT_DEBOUNCE_MS;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Wait for the next input event
+ *
+ * Params:
+ *    [out] event - the event
+ *    [in] millisec - timeout, osWaitForever to wait until input arrives
+ *
+ * Returns:
+ *    1 if an event was received, 0 on timeout
+ *
+ *****************************************************************************/
+uint8_t input_getEvent (input_event_t *event, uint32_t millisec)
+{
+    osEvent evt = osMailGet(inputMail, millisec);
+    input_event_t *ev;
+
+    if (evt.status != osEventMail) {
+        return 0;
+    }
+    ev = (input_event_t*)evt.value.p;
+    *event = *ev;
+    osMailFree(inputMail, ev);
+    return 1;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Number of events lost because the queue was full
+ *
+ *****************************************************************************/
+uint32_t input_getDropped (void)
+{
+    return dropped;
+}
@@ -26,8 +26,9 @@
  * Defines and typedefs
  *****************************************************************************/
 
-#define LED7_CS_OFF() GPIOSetValue( PORT1, 11, 1 )
-#define LED7_CS_ON()  GPIOSetValue( PORT1, 11, 0 )
+/* the SSP port is locked while CS is asserted */
+#define LED7_CS_OFF() do { GPIOPinSet( GPIO_PIN( PORT1, 11 ) ); SSPUnlock(); } while (0)
+#define LED7_CS_ON()  do { SSPLock(); SSPSelect( SSP_CLIENT_LED7 ); GPIOPinClear( GPIO_PIN( PORT1, 11 ) ); } while (0)
 
 
 /******************************************************************************
@@ -86,7 +87,7 @@ static uint8_t chars[] = {
 void led7seg_init (void)
 {
     GPIOSetDir( PORT1, 11, 1 );
-    LED7_CS_OFF();
+    GPIOPinSet( GPIO_PIN( PORT1, 11 ) );
 }
 
 /******************************************************************************
@@ -8,7 +8,7 @@
 
 /*
  * NOTE: I2C must have been initialized before calling any functions in this
- * file.
+ * file. The threshold monitor also needs GPIOInit and a running RTX kernel.
  */
 
 /******************************************************************************
@@ -18,6 +18,8 @@
 #include "mcu_regs.h"
 #include "type.h"
 #include "i2c.h"
+#include "gpio.h"
+#include "cmsis_os.h"
 #include "light.h"
 
 /******************************************************************************
@@ -60,6 +62,8 @@
 #define WIDTH_08_VAL (1 << 8)
 #define WIDTH_04_VAL (1 << 4)
 
+#define SIG_LIGHT_IRQ   0x01
+
 /******************************************************************************
  * External global variables
  *****************************************************************************/
@@ -71,6 +75,15 @@
 static uint32_t range = RANGE_K1;
 static uint32_t width = WIDTH_16_VAL;
 
+static osThreadId monitorThread = NULL;
+static gpio_pin_t irqPin;
+static uint32_t windowPct = LIGHT_WINDOW_PCT;
+static volatile uint32_t lastLux = 0;
+static volatile uint32_t irqCount = 0;
+
+osMessageQDef(light_q, LIGHT_QUEUE_LEN, uint32_t);
+static osMessageQId lightQ = NULL;
+
 /******************************************************************************
  * Local Functions
  *****************************************************************************/
@@ -98,6 +111,68 @@ static uint8_t readControlReg(void)
     return buf[0];
 }
 
+/*
+ * Sensor data value of a threshold. Values above the range are clamped to
+ * full scale, otherwise the register byte (data >> 8) would wrap to a
+ * small value and the sensor would interrupt continuously.
+ */
+static uint32_t luxToData(uint32_t luxTh)
+{
+    if (luxTh >= range) {
+        return width - 1;
+    }
+
+    return (uint32_t)(((uint64_t)luxTh * width) / range);
+}
+
+/*
+ * Arm the threshold window around lux. The thresholds only hold the 8
+ * MSBs of the sensor data, so the window is at least one step wide on
+ * each side.
+ */
+static void armWindow(uint32_t lux)
+{
+    uint32_t step = (range * 256) / width;
+    uint32_t delta = lux * windowPct / 100;
+
+    if (delta < step) {
+        delta = step;
+    }
+    light_setLoThreshold(lux > delta ? lux - delta : 0);
+    light_setHiThreshold(lux + delta + step);
+}
+
+static void lightIrq(uint32_t port, uint32_t pin, void *arg)
+{
+    irqCount++;
+    osSignalSet(monitorThread, SIG_LIGHT_IRQ);
+}
+
+static void lightMonitorTask(void const *args)
+{
+    uint32_t lux;
+
+    lux = light_read();
+    lastLux = lux;
+    armWindow(lux);
+    light_clearIrqStatus();
+
+    while (1) {
+        /* INT is active low and stays asserted until cleared */
+        if (GPIOPinGet(irqPin)) {
+            osSignalWait(SIG_LIGHT_IRQ, osWaitForever);
+        }
+
+        lux = light_read();
+        lastLux = lux;
+        armWindow(lux);
+        light_clearIrqStatus();
+
+        osMessagePut(lightQ, lux, 0);
+    }
+}
+osThreadDef(lightMonitorTask, osPriorityNormal, 1, 0);
+
 /******************************************************************************
  * Public Functions
  *****************************************************************************/
@@ -142,17 +217,16 @@ void light_enable (void)
 uint32_t light_read(void)
 {
     uint32_t data = 0;
+    uint8_t reg;
     uint8_t buf[1];
 
-    buf[0] = ADDR_LSB_SENSOR;
-    I2CWrite(LIGHT_I2C_ADDR, buf, 1);
-    I2CRead(LIGHT_I2C_ADDR, buf, 1);
+    reg = ADDR_LSB_SENSOR;
+    I2CWriteRead(LIGHT_I2C_ADDR, &reg, 1, buf, 1);
 
     data = buf[0];
 
-    buf[0] = ADDR_MSB_SENSOR;
-    I2CWrite(LIGHT_I2C_ADDR, buf, 1);
-    I2CRead(LIGHT_I2C_ADDR, buf, 1);
+    reg = ADDR_MSB_SENSOR;
+    I2CWriteRead(LIGHT_I2C_ADDR, &reg, 1, buf, 1);
 
     data = (buf[0] << 8 | data);
 
@@ -277,9 +351,7 @@ void light_setRange(light_range_t newRange)
 void light_setHiThreshold(uint32_t luxTh)
 {
     uint8_t buf[2];
-    uint32_t data = 0;
-
-    data = luxTh * width / range;
+    uint32_t data = luxToData(luxTh);
 
     buf[0] = ADDR_IRQTH_HI;
     buf[1] = ((data >> 8) & 0xff);
@@ -298,9 +370,7 @@ void light_setHiThreshold(uint32_t luxTh)
 void light_setLoThreshold(uint32_t luxTh)
 {
     uint8_t buf[2];
-    uint32_t data = 0;
-
-    data = luxTh * width / range;
+    uint32_t data = luxToData(luxTh);
 
     buf[0] = ADDR_IRQTH_LO;
     buf[1] = ((data >> 8) & 0xff);
@@ -393,3 +463,85 @@ void light_shutdown(void)
     buf[1] = cmd;
     I2CWrite(LIGHT_I2C_ADDR, buf, 2);
 }
+
+/******************************************************************************
+ *
+ * Description:
+ *    Start the threshold monitor. A thread arms the hi/lo thresholds
+ *    around the current value and sleeps until the sensor pulls its INT
+ *    line, then reads the new value, re-centres the window and posts the
+ *    value. The sensor is not accessed while the light level is steady.
+ *    The sensor must have been enabled with light_enable.
+ *
+ * Params:
+ *    [in]  port  - GPIO port of the sensor INT line
+ *    [in]  pin  - GPIO pin of the sensor INT line
+ *    [in]  pct  - half width of the window in percent of the value,
+ *                 0 for LIGHT_WINDOW_PCT
+ *    [in]  cycles  - integration cycles outside the window before an
+ *                    interrupt (filters short flickers)
+ *
+ *****************************************************************************/
+void light_startMonitor(uint32_t port, uint32_t pin, uint32_t pct,
+                        light_cycle_t cycles)
+{
+    windowPct = (pct != 0) ? pct : LIGHT_WINDOW_PCT;
+    irqPin = GPIO_PIN(port, pin);
+
+    light_setIrqInCycles(cycles);
+
+    if (lightQ == NULL) {
+        lightQ = osMessageCreate(osMessageQ(light_q), NULL);
+        GPIOAttachIrq(port, pin, GPIO_EDGE_FALLING, lightIrq, NULL);
+        monitorThread = osThreadCreate(osThread(lightMonitorTask), NULL);
+    }
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Wait until the monitor reports a new light level
+ *
+ * Params:
+ *    [out] lux  - the new value in Lux
+ *    [in]  millisec  - timeout, osWaitForever to wait for a change
+ *
+ * Returns:
+ *    1 if a new value was received, 0 on timeout
+ *
+ *****************************************************************************/
+uint8_t light_waitChange(uint32_t *lux, uint32_t millisec)
+{
+    osEvent evt = osMessageGet(lightQ, millisec);
+
+    if (evt.status != osEventMessage) {
+        return 0;
+    }
+    *lux = evt.value.v;
+    return 1;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Last value read by the monitor, without any I2C access
+ *
+ * Returns:
+ *    Light level in Lux
+ *
+ *****************************************************************************/
+uint32_t light_getLast(void)
+{
+    return lastLux;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Number of sensor interrupts handled by the monitor
+ *
+ *****************************************************************************/
+uint32_t light_getIrqCount(void)
+{
+    return irqCount;
+}
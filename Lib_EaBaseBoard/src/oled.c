@@ -23,6 +23,7 @@
 #include "gpio.h"
 #include "i2c.h"
 #include "ssp.h"
+#include "cmsis_os.h"
 #include "oled.h"
 #include "font5x7.h"
 
@@ -36,10 +37,11 @@
 #define OLED_I2C_ADDR (0x3c << 1)
 #else
 
-#define OLED_CS_OFF() GPIOSetValue( PORT0, 2, 1 )
-#define OLED_CS_ON()  GPIOSetValue( PORT0, 2, 0 )
-#define OLED_DATA()   GPIOSetValue( PORT2, 7, 1 )
-#define OLED_CMD()    GPIOSetValue( PORT2, 7, 0 )
+/* the SSP port is locked while CS is asserted */
+#define OLED_CS_OFF() do { GPIOPinSet( GPIO_PIN( PORT0, 2 ) ); SSPUnlock(); } while (0)
+#define OLED_CS_ON()  do { SSPLock(); SSPSelect( SSP_CLIENT_OLED ); GPIOPinClear( GPIO_PIN( PORT0, 2 ) ); } while (0)
+#define OLED_DATA()   GPIOPinSet( GPIO_PIN( PORT2, 7 ) )
+#define OLED_CMD()    GPIOPinClear( GPIO_PIN( PORT2, 7 ) )
 
 #endif
 
@@ -51,10 +53,17 @@
 
 #define SHADOW_FB_SIZE (OLED_DISPLAY_WIDTH*OLED_DISPLAY_HEIGHT >> 3)
 
-#define setAddress(page,lowerAddr,higherAddr)\
-    writeCommand(page);\
-    writeCommand(lowerAddr);\
-    writeCommand(higherAddr);
+/* unchanged bytes between two changed ones are sent if there are no more
+   than this, a new column address costs 3 bytes */
+#define RUN_GAP 3
+
+#define SIG_SWAP 0x01
+
+/* the controller has 132 columns per page */
+#define OLED_RAM_WIDTH 132
+
+/* size of the constant buffers repeated bytes are streamed from */
+#define FILL_CHUNK 16
 
 /******************************************************************************
  * External global variables
@@ -75,7 +84,76 @@
  */
 static uint8_t shadowFB[SHADOW_FB_SIZE];
 
-static uint8_t const  font_mask[8] = {0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01};
+/*
+ * Retained mode: drawing only updates shadowFB and the changed column
+ * range of each page; oled_flush sends the ranges to the display.
+ */
+static uint8_t retained = 0;
+static uint8_t dirtyLo[OLED_PAGES];
+static uint8_t dirtyHi[OLED_PAGES];
+
+/*
+ * Double buffering: the application draws into shadowFB (the back
+ * buffer) while the flush thread sends the changed bytes of frontFB,
+ * the frame on the display. oled_swap copies the changes to frontFB
+ * when the thread is idle and marks them in the changed bitmap.
+ */
+static uint8_t doubleBuffered = 0;
+static uint8_t frontFB[SHADOW_FB_SIZE];
+static uint8_t changed[OLED_PAGES][OLED_DISPLAY_WIDTH/8];
+
+static osThreadId flushThread = NULL;
+osSemaphoreDef(oled_front);
+static osSemaphoreId frontFree = NULL;
+
+/*
+ * Display start line: the framebuffer row shown at the top of the panel.
+ * Drawing always uses framebuffer rows, so a start line other than 0
+ * scrolls everything up by that many rows, wrapping around. shownLine is
+ * the line last sent to the display, frontLine the one of frontFB.
+ */
+static uint8_t startLine = 0;
+static uint8_t shownLine = 0;
+static uint8_t frontLine = 0;
+
+/*
+ * Recommended initial code according to manufacturer, sent as one
+ * command list
+ */
+static const uint8_t initSequence[] =
+{
+    0x02,       // set low column address
+    0x12,       // set high column address
+    0x40,       // (display start set)
+    0x2e,       // (stop horzontal scroll)
+    0x81, 0x32, // (set contrast control register)
+    0x82, 0x80, // (brightness for color banks)
+    0xa1,       // (set segment re-map)
+    0xa6,       // (set normal/inverse display)
+//  0xa7,       // (set inverse display)
+    0xa8, 0x3F, // (set multiplex ratio)
+    0xd3, 0x40, // (set display offset)
+    0xad, 0x8E, // (set dc-dc on/off)
+    0xc8,       // (set com output scan direction)
+    0xd5, 0xf0, // (set display clock divide ratio/oscillator/frequency)
+    0xd8, 0x05, // (set area color mode on/off & low power display mode)
+    0xd9, 0xF1, // (set pre-charge period)
+    0xda, 0x12, // (set com pins hardware configuration)
+    0xdb, 0x34, // (set vcom deselect level)
+    0x91, 0x3f, 0x3f, 0x3f, 0x3f, // (set look up table for area color)
+    0xaf,       // (display on)
+    0xa4,       // (display on)
+};
+
+#ifndef OLED_USE_I2C
+static const uint8_t fillBytes[2][FILL_CHUNK] =
+{
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+};
+#endif
 
 
 /******************************************************************************
@@ -85,35 +163,84 @@ static uint8_t const  font_mask[8] = {0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02,
 /******************************************************************************
  *
  * Description:
- *    Write a command to the display
+ *    Write a list of commands to the display in one transfer, with one
+ *    chip select and one D/C change instead of one per byte
  *
  * Params:
- *   [in] data - command to write to the display
+ *   [in] cmds - commands and their arguments
+ *   [in] len - number of bytes, at most sizeof(initSequence)
  *
  *****************************************************************************/
 static void
-writeCommand(uint8_t data)
+writeCommands(const uint8_t *cmds, uint8_t len)
 {
-
 #ifdef OLED_USE_I2C
-    uint8_t buf[2];
+    uint8_t buf[sizeof(initSequence)+1];
 
+    buf[0] = 0x00; // Co = 0: all following bytes are commands
+    memcpy(&buf[1], cmds, len);
 
-    buf[0] = 0x00; // write Co & D/C bits
-    buf[1] = data; // data
-
-    I2CWrite(OLED_I2C_ADDR, buf, 2);
+    I2CWrite(OLED_I2C_ADDR, buf, len+1);
 
 #else
     OLED_CMD();
     OLED_CS_ON();
 
-    SSPSend( (uint8_t *)&data, 1 );
+    SSPSend( (uint8_t *)cmds, len );
 
     OLED_CS_OFF();
 #endif
 }
 
+/* set the page and the lower and higher column address pointers */
+static void
+setAddress(uint8_t page, uint8_t lowerAddr, uint8_t higherAddr)
+{
+    uint8_t cmd[3];
+
+    cmd[0] = page;
+    cmd[1] = lowerAddr;
+    cmd[2] = higherAddr;
+
+    writeCommands(cmd, 3);
+}
+
+#ifndef OLED_USE_I2C
+/*
+ * The following functions are used inside a transfer, with CS asserted
+ * by the caller, to chain address commands and data in one SSP burst.
+ */
+
+/* send the address of a page and controller column */
+static void
+sendAddress(uint8_t page, uint8_t col)
+{
+    uint8_t cmd[3];
+
+    cmd[0] = 0xB0 | page;
+    cmd[1] = 0x0F & col;
+    cmd[2] = 0x10 | (col >> 4);
+
+    OLED_CMD();
+    SSPSend(cmd, 3);
+    OLED_DATA();
+}
+
+/* send len bytes of 0x00 or 0xFF from the constant fill buffer */
+static void
+sendFill(uint8_t data, uint16_t len)
+{
+    const uint8_t *fill = fillBytes[data != 0];
+    uint16_t n;
+
+    while (len > 0) {
+        n = (len < FILL_CHUNK) ? len : FILL_CHUNK;
+        SSPSend((uint8_t *)fill, n);
+        len -= n;
+    }
+}
+#endif
+
 /******************************************************************************
  *
  * Description:
@@ -145,6 +272,7 @@ writeData(uint8_t data)
 #endif
 }
 
+#ifdef OLED_USE_I2C
 /******************************************************************************
  *
  * Description:
@@ -152,43 +280,153 @@ writeData(uint8_t data)
  *
  * Params:
  *   [in] data - data (color) to write to the display
- *   [in] len  - number of bytes to write
+ *   [in] len  - number of bytes to write, at most OLED_RAM_WIDTH
  *
  *****************************************************************************/
 static void
 writeDataLen(unsigned char data, unsigned int len)
 {
-    // TODO: optimize (at least from a RAM point of view)
-
-#ifdef OLED_USE_I2C
-    int i;
-    uint8_t buf[140];
+    uint8_t buf[OLED_RAM_WIDTH+1];
 
     buf[0] = 0x40; // write Co & D/C bits
-
-    for (i = 1; i < len+1; i++) {
-        buf[i] = data;
-    }
+    memset(&buf[1], data, len);
 
     I2CWrite(OLED_I2C_ADDR, buf, len+1);
+}
+#endif
 
-#else
-    int i;
-    uint8_t buf[140];
 
-    for (i = 0; i < len; i++) {
-        buf[i] = data;
+static void markDirty(uint8_t page, uint8_t x0, uint8_t x1)
+{
+    if (x0 < dirtyLo[page]) {
+        dirtyLo[page] = x0;
     }
+    if (x1 > dirtyHi[page]) {
+        dirtyHi[page] = x1;
+    }
+}
+
+/* send columns x0..x1 of a page from a framebuffer */
+static void sendSpan(uint8_t *fb, uint8_t page, uint8_t x0, uint8_t x1)
+{
+    uint16_t add = x0 + X_OFFSET;
+    uint8_t *data = &fb[page*OLED_DISPLAY_WIDTH + x0];
+    uint8_t len = x1 - x0 + 1;
+
+    setAddress(0xB0 | page, 0x0F & add, 0x10 | (add >> 4));
+
+#ifdef OLED_USE_I2C
+    {
+        uint8_t buf[OLED_DISPLAY_WIDTH+1];
 
+        buf[0] = 0x40; // write Co & D/C bits
+        memcpy(&buf[1], data, len);
+        I2CWrite(OLED_I2C_ADDR, buf, len+1);
+    }
+#else
     OLED_DATA();
     OLED_CS_ON();
 
-    SSPSend( (uint8_t *)buf, len );
+    SSPSend( data, len );
 
     OLED_CS_OFF();
 #endif
 }
 
+/* send the start line if the display shows another one */
+static void updateStartLine(uint8_t line)
+{
+    uint8_t cmd;
+
+    if (line != shownLine) {
+        cmd = 0x40 | line;
+        writeCommands(&cmd, 1);
+        shownLine = line;
+    }
+}
+
+/* columns x0..x1 of a page have changed in the framebuffer */
+static void updateSpan(uint8_t page, uint8_t x0, uint8_t x1)
+{
+    if (retained) {
+        markDirty(page, x0, x1);
+    }
+    else {
+        sendSpan(shadowFB, page, x0, x1);
+    }
+}
+
+/* send the runs of changed bytes of frontFB */
+static void flushFront(void)
+{
+    uint8_t page;
+    uint8_t x, x0, x1;
+    uint8_t *bits;
+
+    for (page = 0; page < OLED_PAGES; page++) {
+        bits = changed[page];
+
+        /* no chip select for pages without changes */
+        for (x = 0; x < sizeof(changed[page]) && bits[x] == 0; x++);
+        if (x == sizeof(changed[page])) {
+            continue;
+        }
+        x = 0;
+
+#ifndef OLED_USE_I2C
+        OLED_CS_ON();
+#endif
+        while (x < OLED_DISPLAY_WIDTH) {
+            if ((bits[x >> 3] & (1 << (x & 7))) == 0) {
+                x++;
+                continue;
+            }
+
+            /* extend the run over short gaps */
+            x0 = x1 = x;
+            for (x++; x < OLED_DISPLAY_WIDTH && x - x1 <= RUN_GAP + 1; x++) {
+                if (bits[x >> 3] & (1 << (x & 7))) {
+                    x1 = x;
+                }
+            }
+            x = x1 + 1;
+
+#ifdef OLED_USE_I2C
+            sendSpan(frontFB, page, x0, x1);
+#else
+            sendAddress(page, x0 + X_OFFSET);
+            SSPSend(&frontFB[page*OLED_DISPLAY_WIDTH + x0], x1 - x0 + 1);
+#endif
+        }
+#ifndef OLED_USE_I2C
+        OLED_CS_OFF();
+#endif
+
+        memset(bits, 0, sizeof(changed[page]));
+    }
+
+    updateStartLine(frontLine);
+}
+
+static void oledFlushTask(void const *args)
+{
+    while (1) {
+        osSignalWait(SIG_SWAP, osWaitForever);
+        flushFront();
+        osSemaphoreRelease(frontFree);
+    }
+}
+osThreadDef(oledFlushTask, osPriorityBelowNormal, 1, 0);
+
+static void markClean(void)
+{
+    uint8_t page;
+
+    for (page = 0; page < OLED_PAGES; page++) {
+        dirtyLo[page] = OLED_DISPLAY_WIDTH;
+        dirtyHi[page] = 0;
+    }
+}
 
 /******************************************************************************
  *
@@ -199,48 +437,68 @@ writeDataLen(unsigned char data, unsigned int len)
 static void
 runInitSequence(void)
 {
-    /*
-     * Recommended Initial code according to manufacturer
-     */
-
-    writeCommand(0x02);//set low column address
-    writeCommand(0x12);//set high column address
-    writeCommand(0x40);//(display start set)
-    writeCommand(0x2e);//(stop horzontal scroll)
-    writeCommand(0x81);//(set contrast control register)
-    writeCommand(0x32);
-    writeCommand(0x82);//(brightness for color banks)
-    writeCommand(0x80);//(display on)
-    writeCommand(0xa1);//(set segment re-map)
-    writeCommand(0xa6);//(set normal/inverse display)
-    //  writeCommand(0xa7);//(set inverse display)
-    writeCommand(0xa8);//(set multiplex ratio)
-    writeCommand(0x3F);
-    writeCommand(0xd3);//(set display offset)
-    writeCommand(0x40);
-    writeCommand(0xad);//(set dc-dc on/off)
-    writeCommand(0x8E);//
-    writeCommand(0xc8);//(set com output scan direction)
-    writeCommand(0xd5);//(set display clock divide ratio/oscillator/frequency)
-    writeCommand(0xf0);//
-    writeCommand(0xd8);//(set area color mode on/off & low power display mode )
-    writeCommand(0x05);//
-    writeCommand(0xd9);//(set pre-charge period)
-    writeCommand(0xF1);
-    writeCommand(0xda);//(set com pins hardware configuration)
-    writeCommand(0x12);
-    writeCommand(0xdb);//(set vcom deselect level)
-    writeCommand(0x34);
-    writeCommand(0x91);//(set look up table for area color)
-    writeCommand(0x3f);
-    writeCommand(0x3f);
-    writeCommand(0x3f);
-    writeCommand(0x3f);
-    writeCommand(0xaf);//(display on)
-    writeCommand(0xa4);//(display on)
+    writeCommands(initSequence, sizeof(initSequence));
 }
 
 
+/******************************************************************************
+ *
+ * Description:
+ *    Fill the rectangle x0..x1, y0..y1. Each page of the rectangle is
+ *    updated with one masked OR/AND per column.
+ *
+ * Params:
+ *   [in] x0 - start x position
+ *   [in] x1 - end x position, x1 >= x0
+ *   [in] y0 - start y position
+ *   [in] y1 - end y position, y1 >= y0
+ *   [in] color - color of the pixels
+ *
+ *****************************************************************************/
+static void fillSpan(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1,
+                     oled_color_t color)
+{
+    uint8_t page;
+    uint8_t mask;
+    uint8_t *dst;
+    uint8_t x;
+
+    if (x0 >= OLED_DISPLAY_WIDTH || y0 >= OLED_DISPLAY_HEIGHT) {
+        return;
+    }
+    if (x1 >= OLED_DISPLAY_WIDTH) {
+        x1 = OLED_DISPLAY_WIDTH - 1;
+    }
+    if (y1 >= OLED_DISPLAY_HEIGHT) {
+        y1 = OLED_DISPLAY_HEIGHT - 1;
+    }
+
+    for (page = y0 >> 3; page <= (y1 >> 3); page++) {
+        /* rows of this page inside y0..y1 */
+        mask = 0xFF;
+        if (page == (y0 >> 3)) {
+            mask &= 0xFF << (y0 & 7);
+        }
+        if (page == (y1 >> 3)) {
+            mask &= 0xFF >> (7 - (y1 & 7));
+        }
+
+        dst = &shadowFB[page*OLED_DISPLAY_WIDTH];
+        if (color != OLED_COLOR_BLACK) {
+            for (x = x0; x <= x1; x++) {
+                dst[x] |= mask;
+            }
+        }
+        else {
+            for (x = x0; x <= x1; x++) {
+                dst[x] &= ~mask;
+            }
+        }
+
+        updateSpan(page, x0, x1);
+    }
+}
+
 /******************************************************************************
  *
  * Description:
@@ -255,21 +513,11 @@ runInitSequence(void)
  *****************************************************************************/
 static void hLine(uint8_t x0, uint8_t y0, uint8_t x1, oled_color_t color)
 {
-    // TODO: optimize
-
-    uint8_t bak;
-
-    if (x0 > x1)
-    {
-        bak = x1;
-        x1 = x0;
-        x0 = bak;
+    if (x0 > x1) {
+        fillSpan(x1, x0, y0, y0, color);
     }
-
-    while(x1 >= x0)
-    {
-        oled_putPixel(x0, y0, color);
-        x0++;
+    else {
+        fillSpan(x0, x1, y0, y0, color);
     }
 }
 
@@ -287,21 +535,12 @@ static void hLine(uint8_t x0, uint8_t y0, uint8_t x1, oled_color_t color)
  *****************************************************************************/
 static void vLine(uint8_t x0, uint8_t y0, uint8_t y1, oled_color_t color)
 {
-    uint8_t bak;
-
-    if(y0 > y1)
-    {
-        bak = y1;
-        y1 = y0;
-        y0 = bak;
+    if (y0 > y1) {
+        fillSpan(x0, x0, y1, y0, color);
     }
-
-    while(y1 >= y0)
-    {
-        oled_putPixel(x0, y0, color);
-        y0++;
+    else {
+        fillSpan(x0, x0, y0, y1, color);
     }
-    return;
 }
 
 
@@ -331,12 +570,14 @@ void oled_init (void)
     GPIOSetValue( PORT2, 7, 0 ); // D/C#
     GPIOSetValue( PORT0, 2, 0 ); // CS#
 #else
-    OLED_CS_OFF();
+    GPIOPinSet( GPIO_PIN( PORT0, 2 ) ); // CS#
 #endif
 
     runInitSequence();
 
     memset(shadowFB, 0, SHADOW_FB_SIZE);
+    markClean();
+    startLine = shownLine = frontLine = 0;
 
     /* small delay before turning on power */
     for (i = 0; i < 0xffff; i++);
@@ -364,10 +605,10 @@ void oled_putPixel(uint8_t x, uint8_t y, oled_color_t color) {
     uint8_t mask;
     uint32_t shadowPos = 0;
 
-    if (x > OLED_DISPLAY_WIDTH) {
+    if (x >= OLED_DISPLAY_WIDTH) {
         return;
     }
-    if (y > OLED_DISPLAY_HEIGHT) {
+    if (y >= OLED_DISPLAY_HEIGHT) {
         return;
     }
 
@@ -391,9 +632,6 @@ void oled_putPixel(uint8_t x, uint8_t y, oled_color_t color) {
     add = y - add;                  // Calculate bit position
     mask = 1 << add;                // Left shift 1 by bit position
 
-    setAddress(page, lAddr, hAddr); // Set the address (sets the page,
-                                    // lower and higher column address pointers)
-
     shadowPos = (page-0xB0)*OLED_DISPLAY_WIDTH+x;
 
     if(color > 0)
@@ -401,6 +639,13 @@ void oled_putPixel(uint8_t x, uint8_t y, oled_color_t color) {
     else
         shadowFB[shadowPos] &= ~mask;
 
+    if (retained) {
+        markDirty(page-0xB0, x, x);
+        return;
+    }
+
+    setAddress(page, lAddr, hAddr); // Set the address (sets the page,
+                                    // lower and higher column address pointers)
 
     writeData(shadowFB[shadowPos]);
 }
@@ -424,6 +669,7 @@ void oled_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t colo
     int8_t    dx_sym = 0, dy_sym = 0;
     int16_t   dx_x2 = 0, dy_x2 = 0;
     int16_t   di = 0;
+    uint8_t   run = 0;
 
     dx = x1-x0;
     dy = y1-y0;
@@ -467,13 +713,13 @@ void oled_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t colo
     dx_x2 = dx*2;
     dy_x2 = dy*2;
 
+    /* the pixels are drawn as runs along the major axis */
     if(dx >= dy)
     {
         di = dy_x2 - dx;
+        run = x0;
         while(x0 != x1)
         {
-
-            oled_putPixel(x0, y0, color);
             x0 += dx_sym;
             if(di<0)
             {
@@ -482,17 +728,19 @@ void oled_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t colo
             else
             {
                 di += dy_x2 - dx_x2;
+                hLine(run, y0, x0 - dx_sym, color);
+                run = x0;
                 y0 += dy_sym;
             }
         }
-        oled_putPixel(x0, y0, color);
+        hLine(run, y0, x0, color);
     }
     else
     {
         di = dx_x2 - dy;
+        run = y0;
         while(y0 != y1)
         {
-            oled_putPixel(x0, y0, color);
             y0 += dy_sym;
             if(di < 0)
             {
@@ -501,10 +749,12 @@ void oled_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t colo
             else
             {
                 di += dx_x2 - dy_x2;
+                vLine(x0, run, y0 - dy_sym, color);
+                run = y0;
                 x0 += dx_sym;
             }
         }
-        oled_putPixel(x0, y0, color);
+        vLine(x0, run, y0, color);
     }
     return;
 }
@@ -698,24 +948,111 @@ void oled_fillRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, oled_color_t
         y1 = i;
     }
 
-    if(y0 == y1)
-    {
-        hLine(x0, y0, x1, color);
-        return;
-    }
+    fillSpan(x0, x1, y0, y1, color);
+    return;
+}
 
-    if(x0 == x1)
-    {
-        vLine(x0, y0, y1, color);
+/******************************************************************************
+ *
+ * Description:
+ *    Draw a bitmap. The bitmap has the layout of the framebuffer: (h+7)/8
+ *    pages of w column bytes, LSB at the top, a set bit is a lit pixel.
+ *    The raster operation is applied a byte at a time to the framebuffer.
+ *    When y is a multiple of 8 every byte is taken as is, otherwise it is
+ *    assembled from two bitmap pages. Parts outside the display are
+ *    clipped.
+ *
+ * Params:
+ *   [in] x - x position of the left column, may be negative
+ *   [in] y - y position of the top row, may be negative
+ *   [in] w - width of the bitmap
+ *   [in] h - height of the bitmap
+ *   [in] bitmap - bitmap data
+ *   [in] rop - raster operation
+ *
+ *****************************************************************************/
+void oled_blit(int16_t x, int16_t y, uint8_t w, uint8_t h,
+        const uint8_t *bitmap, oled_rop_t rop)
+{
+    int16_t x0 = (x < 0) ? 0 : x;
+    int16_t y0 = (y < 0) ? 0 : y;
+    int16_t x1 = x + w - 1;
+    int16_t y1 = y + h - 1;
+    int16_t srcPages = (h + 7) >> 3;
+    int16_t srcPage;
+    uint8_t page;
+    uint8_t shift;
+    uint8_t mask;
+    uint8_t n;
+    uint8_t i;
+    uint8_t *dst;
+    const uint8_t *lo;
+    const uint8_t *hi;
+    uint8_t src;
+
+    if (x1 >= OLED_DISPLAY_WIDTH) {
+        x1 = OLED_DISPLAY_WIDTH - 1;
+    }
+    if (y1 >= OLED_DISPLAY_HEIGHT) {
+        y1 = OLED_DISPLAY_HEIGHT - 1;
+    }
+    if (x0 > x1 || y0 > y1) {
         return;
     }
+    n = x1 - x0 + 1;
 
-    while(y0 <= y1)
-    {
-        hLine(x0, y0, x1, color);
-        y0++;
+    for (page = y0 >> 3; page <= (y1 >> 3); page++) {
+        mask = 0xFF;
+        if (page == (y0 >> 3)) {
+            mask &= 0xFF << (y0 & 7);
+        }
+        if (page == (y1 >> 3)) {
+            mask &= 0xFF >> (7 - (y1 & 7));
+        }
+
+        /* bitmap pages holding the rows of this page, row page*8 - y
+           is at bit 'shift' of page 'srcPage' */
+        srcPage = ((page*8 - y + 8) >> 3) - 1;
+        shift = (page*8 - y + 8) & 7;
+        lo = (srcPage >= 0) ?
+            &bitmap[srcPage*w + (x0 - x)] : NULL;
+        hi = (shift != 0 && srcPage + 1 < srcPages) ?
+            &bitmap[(srcPage+1)*w + (x0 - x)] : NULL;
+
+        dst = &shadowFB[page*OLED_DISPLAY_WIDTH + x0];
+
+        if (hi == NULL && shift == 0 && mask == 0xFF && rop == OLED_ROP_COPY) {
+            memcpy(dst, lo, n);
+        }
+        else {
+            for (i = 0; i < n; i++) {
+                src = 0;
+                if (lo != NULL) {
+                    src = lo[i] >> shift;
+                }
+                if (hi != NULL) {
+                    src |= hi[i] << (8 - shift);
+                }
+
+                switch (rop) {
+                case OLED_ROP_COPY:
+                    dst[i] = (dst[i] & ~mask) | (src & mask);
+                    break;
+                case OLED_ROP_OR:
+                    dst[i] |= src & mask;
+                    break;
+                case OLED_ROP_AND:
+                    dst[i] &= src | ~mask;
+                    break;
+                case OLED_ROP_XOR:
+                    dst[i] ^= src & mask;
+                    break;
+                }
+            }
+        }
+
+        updateSpan(page, x0, x1);
     }
-    return;
 }
 
 /******************************************************************************
@@ -735,21 +1072,223 @@ void oled_clearScreen(oled_color_t color)
     if (color == OLED_COLOR_WHITE)
         c = 0xff;
 
+    if (retained) {
+        memset(shadowFB, c, SHADOW_FB_SIZE);
+        for (i = 0; i < OLED_PAGES; i++) {
+            markDirty(i, 0, OLED_DISPLAY_WIDTH-1);
+        }
+        return;
+    }
 
+#ifdef OLED_USE_I2C
     for(i=0xB0;i<0xB8;i++) {            // Go through all 8 pages
         setAddress(i,0x00,0x10);
-        writeDataLen(c, 132);
+        writeDataLen(c, OLED_RAM_WIDTH);
     }
+#else
+    /* all 8 pages, including the columns outside the panel, in one burst */
+    OLED_CS_ON();
+    for (i = 0; i < OLED_PAGES; i++) {
+        sendAddress(i, 0);
+        sendFill(c, OLED_RAM_WIDTH);
+    }
+    OLED_CS_OFF();
+#endif
 
     memset(shadowFB, c, SHADOW_FB_SIZE);
 }
 
-uint8_t oled_putChar(uint8_t x, uint8_t y, uint8_t ch, oled_color_t fb, oled_color_t bg)
+/******************************************************************************
+ *
+ * Description:
+ *    Select retained mode. In retained mode drawing functions only update
+ *    the framebuffer and nothing is sent to the display until oled_flush
+ *    is called. Leaving retained mode flushes pending changes.
+ *
+ * Params:
+ *   [in] enable - TRUE for retained mode, FALSE to draw immediately
+ *
+ *****************************************************************************/
+void oled_setRetained(uint8_t enable)
+{
+    if (retained && !enable) {
+        oled_flush();
+    }
+    retained = enable;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Select double buffering. Drawing goes to the back buffer as in
+ *    retained mode and oled_swap hands the frame to a low priority
+ *    thread that sends it to the display. Needs a running RTX kernel.
+ *    Leaving double buffering waits for the last frame and returns to
+ *    immediate mode.
+ *
+ * Params:
+ *   [in] enable - TRUE for double buffering
+ *
+ *****************************************************************************/
+void oled_setDoubleBuffered(uint8_t enable)
+{
+    if (enable && !doubleBuffered) {
+        if (flushThread == NULL) {
+            frontFree = osSemaphoreCreate(osSemaphore(oled_front), 1);
+            flushThread = osThreadCreate(osThread(oledFlushTask), NULL);
+        }
+
+        /* the display is up to date, both buffers hold the same frame */
+        if (retained) {
+            oled_flush();
+        }
+        memcpy(frontFB, shadowFB, SHADOW_FB_SIZE);
+        retained = 1;
+        doubleBuffered = 1;
+    }
+    else if (!enable && doubleBuffered) {
+        oled_swap();
+        osSemaphoreWait(frontFree, osWaitForever);
+        osSemaphoreRelease(frontFree);
+        doubleBuffered = 0;
+        retained = 0;
+    }
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Present the back buffer. Waits until the previous frame has been
+ *    sent, like waiting for vsync, then copies the bytes that differ from
+ *    the displayed frame and returns while the flush thread sends them.
+ *    The application can draw the next frame right away; the frame on
+ *    the display is never a mix of two frames.
+ *
+ *****************************************************************************/
+void oled_swap(void)
+{
+    uint8_t page;
+    uint8_t x;
+    uint16_t pos;
+
+    if (!doubleBuffered) {
+        oled_flush();
+        return;
+    }
+
+    osSemaphoreWait(frontFree, osWaitForever);
+
+    /* outside the dirty ranges both buffers are equal */
+    for (page = 0; page < OLED_PAGES; page++) {
+        for (x = dirtyLo[page]; x <= dirtyHi[page] && x < OLED_DISPLAY_WIDTH; x++) {
+            pos = page*OLED_DISPLAY_WIDTH + x;
+            if ((shadowFB[pos] ^ frontFB[pos]) != 0) {
+                frontFB[pos] = shadowFB[pos];
+                changed[page][x >> 3] |= (1 << (x & 7));
+            }
+        }
+    }
+    markClean();
+    frontLine = startLine;
+
+    osSignalSet(flushThread, SIG_SWAP);
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Send the changed column range of each page to the display. With SPI
+ *    the whole update is one transfer with CS asserted, D/C selects the
+ *    address commands and data of each page.
+ *
+ *****************************************************************************/
+void oled_flush(void)
+{
+    uint8_t page;
+
+    if (doubleBuffered) {
+        oled_swap();
+        osSemaphoreWait(frontFree, osWaitForever);
+        osSemaphoreRelease(frontFree);
+        return;
+    }
+
+#ifdef OLED_USE_I2C
+    for (page = 0; page < OLED_PAGES; page++) {
+        if (dirtyLo[page] <= dirtyHi[page]) {
+            sendSpan(shadowFB, page, dirtyLo[page], dirtyHi[page]);
+        }
+    }
+#else
+    OLED_CS_ON();
+
+    for (page = 0; page < OLED_PAGES; page++) {
+        if (dirtyLo[page] > dirtyHi[page]) {
+            continue;
+        }
+
+        sendAddress(page, dirtyLo[page] + X_OFFSET);
+        SSPSend(&shadowFB[page*OLED_DISPLAY_WIDTH + dirtyLo[page]],
+                dirtyHi[page] - dirtyLo[page] + 1);
+    }
+
+    OLED_CS_OFF();
+#endif
+
+    markClean();
+    updateStartLine(startLine);
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Set the display start line, the framebuffer row shown at the top of
+ *    the panel. The panel then shows rows line..63 followed by 0..line-1,
+ *    so stepping the line by one scrolls the whole display up one row
+ *    without sending any pixel data. Like drawing, the change is sent on
+ *    the next flush in retained and double buffered mode.
+ *
+ * Params:
+ *   [in] line - start line, 0..63
+ *
+ *****************************************************************************/
+void oled_setStartLine(uint8_t line)
 {
-    unsigned char data = 0;
-    unsigned char i = 0, j = 0;
+    startLine = line & (OLED_DISPLAY_HEIGHT - 1);
 
-    oled_color_t color = OLED_COLOR_BLACK;
+    if (!retained) {
+        updateStartLine(startLine);
+    }
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Draw a character. The glyph is taken from the column-major font
+ *    table and written as one byte per column, or two shifted bytes in
+ *    adjacent pages when y is not a multiple of 8.
+ *
+ * Params:
+ *   [in] x - x position
+ *   [in] y - y position
+ *   [in] ch - character
+ *   [in] fb - foreground color
+ *   [in] bg - background color
+ *
+ * Returns:
+ *   1 if the character was drawn, 0 if it is outside the display
+ *
+ *****************************************************************************/
+uint8_t oled_putChar(uint8_t x, uint8_t y, uint8_t ch, oled_color_t fb, oled_color_t bg)
+{
+    const uint8_t *glyph;
+    uint8_t fgBits = (fb == OLED_COLOR_BLACK) ? 0x00 : 0xFF;
+    uint8_t bgBits = (bg == OLED_COLOR_BLACK) ? 0x00 : 0xFF;
+    uint8_t page = y >> 3;
+    uint8_t shift = y & 7;
+    uint8_t *dst;
+    uint8_t col;
+    uint8_t i;
 
     if((x >= (OLED_DISPLAY_WIDTH - 8)) || (y >= (OLED_DISPLAY_HEIGHT - 8)) )
     {
@@ -761,26 +1300,25 @@ uint8_t oled_putChar(uint8_t x, uint8_t y, uint8_t ch, oled_color_t fb, oled_col
         ch = 0x20;      /* unknown character will be set to blank */
     }
 
-    ch -= 0x20;
-    for(i=0; i<8; i++)
-    {
-        data = font5x7[ch][i];
-        for(j=0; j<6; j++)
-        {
-            if( (data&font_mask[j])==0 )
-            {
-                color = bg;
-            }
-            else
-            {
-                color = fb;
-            }
-            oled_putPixel(x, y, color);
-            x++;
+    glyph = font5x7_cols[ch - 0x20];
+    dst = &shadowFB[page*OLED_DISPLAY_WIDTH + x];
+
+    for (i = 0; i < FONT5X7_WIDTH; i++) {
+        col = (glyph[i] & fgBits) | (~glyph[i] & bgBits);
+
+        dst[i] = (dst[i] & ~(0xFF << shift)) | (col << shift);
+        if (shift != 0) {
+            dst[i+OLED_DISPLAY_WIDTH] =
+                (dst[i+OLED_DISPLAY_WIDTH] & ~(0xFF >> (8 - shift)))
+                | (col >> (8 - shift));
         }
-        y++;
-        x -= 6;
     }
+
+    updateSpan(page, x, x + FONT5X7_WIDTH - 1);
+    if (shift != 0) {
+        updateSpan(page + 1, x, x + FONT5X7_WIDTH - 1);
+    }
+
     return( 1 );
 }
 
@@ -797,7 +1335,123 @@ void oled_putString(uint8_t x, uint8_t y, uint8_t *pStr, oled_color_t fb,
       {
         break;
     }
-    x += 6;
+    x += FONT5X7_WIDTH;
   }
   return;
 }
+
+/******************************************************************************
+ *
+ * Description:
+ *    Draw a string with a packed proportional font. Each glyph column is
+ *    unpacked once from the bit stream and written as page bytes straight
+ *    into the framebuffer, shifted across the pages it covers when y is not
+ *    a multiple of 8. Characters the font does not have are skipped.
+ *
+ * Params:
+ *   [in] x - x position
+ *   [in] y - y position of the top of the text
+ *   [in] pStr - string
+ *   [in] font - packed font, see font.h
+ *   [in] fb - foreground color
+ *   [in] bg - background color
+ *
+ * Returns:
+ *   x position after the last character drawn
+ *
+ *****************************************************************************/
+uint8_t oled_putText(uint8_t x, uint8_t y, uint8_t *pStr, const font_t *font,
+        oled_color_t fb, oled_color_t bg)
+{
+    uint32_t fgBits = (fb == OLED_COLOR_BLACK) ? 0 : 0xFFFFFFFF;
+    uint32_t bgBits = (bg == OLED_COLOR_BLACK) ? 0 : 0xFFFFFFFF;
+    uint32_t colMask = (1UL << font->height) - 1;
+    uint8_t page = y >> 3;
+    uint8_t shift = y & 7;
+    uint8_t lastPage;
+    uint8_t x0 = x;
+    uint8_t p;
+
+    if (y + font->height > OLED_DISPLAY_HEIGHT) {
+        return x;
+    }
+    lastPage = (y + font->height - 1) >> 3;
+
+    for (; *pStr != '\0'; pStr++) {
+        const uint8_t *bits;
+        uint32_t acc = 0;
+        uint8_t nbits = 0;
+        uint8_t idx;
+        uint8_t w;
+        uint8_t i;
+
+        if (*pStr < font->first || *pStr > font->last) {
+            continue;
+        }
+        idx = *pStr - font->first;
+        w = font->width[idx];
+        if (w == 0) {
+            continue;
+        }
+        if (x + w > OLED_DISPLAY_WIDTH) {
+            break;
+        }
+
+        bits = &font->bits[font->offset[idx]];
+        for (i = 0; i < w; i++, x++) {
+            uint8_t *dst = &shadowFB[page*OLED_DISPLAY_WIDTH + x];
+            uint32_t mask = colMask << shift;
+            uint32_t col;
+
+            while (nbits < font->height) {
+                acc |= (uint32_t)*bits++ << nbits;
+                nbits += 8;
+            }
+            col = acc;
+            acc >>= font->height;
+            nbits -= font->height;
+
+            col = ((col & fgBits) | (~col & bgBits)) << shift;
+            for (p = page; p <= lastPage; p++) {
+                *dst = (*dst & ~mask) | (col & mask);
+                dst += OLED_DISPLAY_WIDTH;
+                col >>= 8;
+                mask >>= 8;
+            }
+        }
+    }
+
+    if (x > x0) {
+        for (p = page; p <= lastPage; p++) {
+            updateSpan(p, x0, x - 1);
+        }
+    }
+
+    return x;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Width of a string in a packed font, e.g. to right align a readout
+ *
+ * Params:
+ *   [in] pStr - string
+ *   [in] font - packed font, see font.h
+ *
+ * Returns:
+ *   Width in pixels
+ *
+ *****************************************************************************/
+uint16_t oled_textWidth(uint8_t *pStr, const font_t *font)
+{
+    uint16_t width = 0;
+
+    for (; *pStr != '\0'; pStr++) {
+        if (*pStr >= font->first && *pStr <= font->last) {
+            width += font->width[*pStr - font->first];
+        }
+    }
+
+    return width;
+}
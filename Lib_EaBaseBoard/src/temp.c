@@ -18,6 +18,7 @@
 #include "mcu_regs.h"
 #include "type.h"
 #include "gpio.h"
+#include "cmsis_os.h"
 #include "temp.h"
 
 /******************************************************************************
@@ -36,6 +37,25 @@
  */
 //#define TEMP_USE_P0_2
 
+/*
+ * Capture mode: every edge of the sensor output is time stamped by a timer
+ * capture input (CT32B0_CAP0 on P1.5, CT16B0_CAP0 on P0.2) and the periods
+ * are averaged in the timer interrupt. temp_read then returns the latest
+ * average at once. The driver then owns the timer and its interrupt
+ * handler, so the application must not use timer32 0 (P1.5) or timer16 0
+ * (P0.2) itself, e.g. with delay32Ms, nor link the generic timer
+ * interrupts. Off by default: the polled measurement needs no timer.
+ * Define TEMP_USE_CAPTURE as 1 in temp.h or in the project options.
+ */
+#ifndef TEMP_USE_CAPTURE
+#define TEMP_USE_CAPTURE 0
+#endif
+
+/* longest wait in temp_read for the first capture window, checked every
+   TEMP_CAPTURE_POLL ms */
+#define TEMP_CAPTURE_TIMEOUT 1000
+#define TEMP_CAPTURE_POLL    10
+
 #if TEMP_TS1 == 0 && TEMP_TS0 == 0
 #define TEMP_SCALAR_DIV10 1
 #define NUM_HALF_PERIODS 340
@@ -59,6 +79,31 @@
 #define    GET_TEMP_STATE P1_5_STATE
 #endif
 
+#if TEMP_USE_CAPTURE
+#ifdef TEMP_USE_P0_2
+#define TEMP_TMR          LPC_TMR16B0
+#define TEMP_TMR_IRQn     TIMER_16_0_IRQn
+#define TEMP_TMR_CLK      (1<<7)
+#define TEMP_TMR_IRQHandler TIMER16_0_IRQHandler   /* 16 bits */
+/*
+ * The 16-bit timer wraps after 65536 ticks. A half period is
+ * scalar_div10 * 10T(K) / 2 us, up to ~135 ms at 150 C with the x64
+ * scalar, so that one counts 4 us ticks (262 ms range), the others 1 us.
+ */
+#if TEMP_SCALAR_DIV10 == 64
+#define TEMP_TMR_US       4
+#else
+#define TEMP_TMR_US       1
+#endif
+#else
+#define TEMP_TMR          LPC_TMR32B0
+#define TEMP_TMR_IRQn     TIMER_32_0_IRQn
+#define TEMP_TMR_CLK      (1<<9)
+#define TEMP_TMR_IRQHandler TIMER32_0_IRQHandler   /* 32 bits, PCLK ticks */
+#define TEMP_TMR_US       1
+#endif
+#endif
+
 
 /******************************************************************************
  * External global variables
@@ -70,10 +115,50 @@
 
 static uint32_t (*getTicks)(void) = NULL;
 
+#if TEMP_USE_CAPTURE
+static uint32_t ticksPerUs = 1;
+static uint32_t lastCapture = 0;
+static uint32_t halfPeriods = 0;
+static uint32_t sumTicks = 0;
+static volatile uint32_t avgTicks = 0;   /* NUM_HALF_PERIODS half periods */
+static volatile uint8_t first = 1;
+#endif
+
 /******************************************************************************
  * Local Functions
  *****************************************************************************/
 
+#if TEMP_USE_CAPTURE
+/*
+ * Capture interrupt, one per sensor edge. Sums NUM_HALF_PERIODS half
+ * periods and publishes the sum, the same window temp_read used to poll.
+ */
+void TEMP_TMR_IRQHandler(void)
+{
+    uint32_t capture;
+
+    TEMP_TMR->IR = (1<<4);              /* clear CR0 interrupt */
+    capture = TEMP_TMR->CR0;
+
+    if (first) {
+        first = 0;
+    }
+    else {
+#ifdef TEMP_USE_P0_2
+        sumTicks += (uint16_t)(capture - lastCapture);
+#else
+        sumTicks += capture - lastCapture;
+#endif
+        if (++halfPeriods == NUM_HALF_PERIODS) {
+            avgTicks = sumTicks;
+            sumTicks = 0;
+            halfPeriods = 0;
+        }
+    }
+    lastCapture = capture;
+}
+#endif
+
 /******************************************************************************
  * Public Functions
  *****************************************************************************/
@@ -96,6 +181,34 @@ void temp_init (uint32_t (*getMsTicks)(void))
     GPIOSetDir( PORT1, 5, 0 );
 #endif
     getTicks = getMsTicks;
+
+#if TEMP_USE_CAPTURE
+    LPC_SYSCON->SYSAHBCLKCTRL |= TEMP_TMR_CLK;
+#ifdef TEMP_USE_P0_2
+    LPC_IOCON->PIO0_2 &= ~0x07;
+    LPC_IOCON->PIO0_2 |= 0x02;          /* CT16B0_CAP0 */
+    ticksPerUs = 1;
+    TEMP_TMR->PR = (SystemCoreClock/LPC_SYSCON->SYSAHBCLKDIV) / 1000000
+        * TEMP_TMR_US - 1;
+#else
+    LPC_IOCON->PIO1_5 &= ~0x07;
+    LPC_IOCON->PIO1_5 |= 0x02;          /* CT32B0_CAP0 */
+    ticksPerUs = (SystemCoreClock/LPC_SYSCON->SYSAHBCLKDIV) / 1000000;
+    TEMP_TMR->PR = 0;
+#endif
+    TEMP_TMR->TCR = 0x02;               /* reset */
+    TEMP_TMR->MCR = 0;                  /* free running */
+    TEMP_TMR->CCR = 0x07;               /* capture both edges, interrupt */
+    TEMP_TMR->IR = 0xFF;
+
+    first = 1;
+    halfPeriods = 0;
+    sumTicks = 0;
+    avgTicks = 0;
+
+    NVIC_EnableIRQ(TEMP_TMR_IRQn);
+    TEMP_TMR->TCR = 0x01;
+#endif
 }
 
 /******************************************************************************
@@ -106,10 +219,40 @@ void temp_init (uint32_t (*getMsTicks)(void))
  * Returns:
  *    10 x T(c), i.e. 10 times the temperature in Celcius. Example:
  *    if the temperature is 22.4 degrees the returned value is 224.
+ *    In capture mode TEMP_NO_READING if no sensor edges were captured
+ *    within TEMP_CAPTURE_TIMEOUT ms.
  *
  *****************************************************************************/
 int32_t temp_read (void)
 {
+#if TEMP_USE_CAPTURE
+    uint32_t ticks;
+    uint32_t waited = 0;
+    volatile uint32_t spin;
+
+    /*
+     * 10T(C) = (period (us) / scalar_div10) - 2731 K, with the period
+     * averaged over NUM_HALF_PERIODS / 2 periods. Only the very first
+     * call after temp_init waits for a full window.
+     */
+    while ((ticks = avgTicks) == 0) {
+        /* timed without the capture timer, which may have been stopped
+           by another user: that is what makes the wait endless */
+        if (waited >= TEMP_CAPTURE_TIMEOUT) {
+            return TEMP_NO_READING;
+        }
+        if (osKernelRunning()) {
+            osDelay(TEMP_CAPTURE_POLL);
+        }
+        else {
+            /* at least 4 cycles per iteration */
+            for (spin = SystemCoreClock / 4000 * TEMP_CAPTURE_POLL; spin > 0; spin--);
+        }
+        waited += TEMP_CAPTURE_POLL;
+    }
+
+    return ( (2*ticks*TEMP_TMR_US) / (NUM_HALF_PERIODS*ticksPerUs*TEMP_SCALAR_DIV10) - 2731 );
+#else
     uint8_t state = 0;
     uint32_t t1 = 0;
     uint32_t t2 = 0;
@@ -144,4 +287,5 @@ int32_t temp_read (void)
 
 
     return ( (2*1000*t2) / (NUM_HALF_PERIODS*TEMP_SCALAR_DIV10) - 2731 );
+#endif
 }
@@ -14,6 +14,12 @@
 #define ADC_INTERRUPT_FLAG	0	/* 1 is interrupt driven, 0 is polling */
 #define BURST_MODE			0   /* Burst mode works in interrupt driven mode only. */
 #define ADC_DEBUG			1
+#define ADC_STREAM			1	/* continuous acquisition into ping-pong buffers */
+#define ADC_STREAM_JITTER	1	/* time stamp stream samples with the cycle counter */
+
+#if ADC_STREAM && ADC_INTERRUPT_FLAG
+#error ADC_STREAM and ADC_INTERRUPT_FLAG both use ADC_IRQHandler
+#endif
 
 #define ADC_OFFSET		0x10
 #define ADC_INDEX		4
@@ -24,11 +30,46 @@
 
 #define ADC_NUM			8			/* for LPC13xx */
 #define ADC_CLK			1000000		/* set to 1Mhz */
+#define ADC_CLK_MAX		4500000		/* 4.5Mhz upper limit of the ADC clock */
+
+/* Stream triggers, the values are the CR START field */
+#define ADC_TRIG_BURST			0	/* free running burst scan */
+#define ADC_TRIG_CT32B0_MAT0	4
+#define ADC_TRIG_CT32B0_MAT1	5
+#define ADC_TRIG_CT16B0_MAT0	6
+#define ADC_TRIG_CT16B0_MAT1	7
+
+/* Interval histogram, bins are centred on the nominal interval */
+#define ADC_JITTER_BINS			16
+#define ADC_JITTER_BIN_CYCLES	72	/* 1us at 72Mhz */
+
+typedef struct
+{
+  uint32_t nominal;			/* expected interval, cycles */
+  uint32_t last;			/* previous time stamp, cycles */
+  uint32_t count;			/* intervals recorded */
+  uint32_t min;
+  uint32_t max;
+  uint32_t hist[ADC_JITTER_BINS];	/* underflow in bin 0, overflow in the last */
+} ADCJitter;
 
 extern void ADC_IRQHandler( void );
 extern void ADCInit( uint32_t ADC_Clk );
 extern uint32_t ADCRead( uint8_t channelNum );
 extern void ADCBurstRead( void );
+#if ADC_STREAM
+extern uint32_t ADCStreamStart( uint16_t *buffer, uint32_t samples, uint8_t channelMask,
+                                uint32_t rate, uint8_t trigger,
+                                void *consumer, int32_t signal );
+extern void ADCStreamStop( void );
+extern uint16_t *ADCStreamGetBuffer( void );
+extern uint32_t ADCStreamGetOverrun( void );
+extern void ADCJitterInit( ADCJitter *jitter, uint32_t nominal );
+extern void ADCJitterAdd( ADCJitter *jitter, uint32_t stamp );
+#if ADC_STREAM_JITTER
+extern void ADCStreamGetJitter( ADCJitter *jitter );
+#endif
+#endif
 #endif /* end __ADC_H */
 /*****************************************************************************
 **                            End Of File
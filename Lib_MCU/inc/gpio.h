@@ -16,6 +16,67 @@
 #define PORT2		2
 #define PORT3		3
 
+#define GPIO_IRQ_DISPATCH	1	/* 1 installs the table driven PIOINTx handlers */
+#define GPIO_PINS_PER_PORT	12
+
+/* GPIOAttachIrq edge selection */
+#define GPIO_EDGE_FALLING	0x1
+#define GPIO_EDGE_RISING	0x2
+#define GPIO_EDGE_BOTH		0x3
+
+/* Message value posted by GPIOIrqPostMessage */
+#define GPIO_IRQ_MSG(portNum, bitPosi)	(((portNum) << 8) | (bitPosi))
+
+/* Called in interrupt context with the pin that fired */
+typedef void (*GPIOIrqCallback)( uint32_t portNum, uint32_t bitPosi, void *arg );
+
+/* Argument of GPIOIrqPostSignal */
+typedef struct
+{
+  void *thread;				/* osThreadId */
+  int32_t signals;
+} GPIOIrqSignal;
+
+/*
+ * Masked access pin API. Each port decodes address bits 13:2 as a mask,
+ * so a store to MASKED_ACCESS[mask] only changes the masked pins. This
+ * is atomic (no read-modify-write) and, with constant port and bit, the
+ * inline functions below compile to a single store.
+ */
+typedef struct
+{
+  LPC_GPIO_TypeDef *port;
+  uint32_t mask;
+} gpio_pin_t;
+
+#define GPIO_PORT(portNum)		((LPC_GPIO_TypeDef *)(LPC_GPIO0_BASE + (portNum) * 0x10000))
+#define GPIO_PIN(portNum, bitPosi)	((gpio_pin_t){ GPIO_PORT(portNum), 1UL << (bitPosi) })
+
+static __INLINE void GPIOPinSet( gpio_pin_t pin )
+{
+  pin.port->MASKED_ACCESS[pin.mask] = pin.mask;
+}
+
+static __INLINE void GPIOPinClear( gpio_pin_t pin )
+{
+  pin.port->MASKED_ACCESS[pin.mask] = 0;
+}
+
+static __INLINE void GPIOPinWrite( gpio_pin_t pin, uint32_t bitVal )
+{
+  pin.port->MASKED_ACCESS[pin.mask] = bitVal ? pin.mask : 0;
+}
+
+static __INLINE void GPIOPinToggle( gpio_pin_t pin )
+{
+  pin.port->MASKED_ACCESS[pin.mask] ^= pin.mask;
+}
+
+static __INLINE uint32_t GPIOPinGet( gpio_pin_t pin )
+{
+  return pin.port->MASKED_ACCESS[pin.mask] != 0;
+}
+
 void GPIO_IRQHandler(void);
 void GPIOInit( void );
 void GPIOSetDir( uint32_t portNum, uint32_t bitPosi, uint32_t dir );
@@ -27,6 +88,13 @@ void GPIOIntEnable( uint32_t portNum, uint32_t bitPosi );
 void GPIOIntDisable( uint32_t portNum, uint32_t bitPosi );
 uint32_t GPIOIntStatus( uint32_t portNum, uint32_t bitPosi );
 void GPIOIntClear( uint32_t portNum, uint32_t bitPosi );
+#if GPIO_IRQ_DISPATCH
+void GPIOAttachIrq( uint32_t portNum, uint32_t bitPosi, uint32_t edge,
+		GPIOIrqCallback callback, void *arg );
+void GPIODetachIrq( uint32_t portNum, uint32_t bitPosi );
+void GPIOIrqPostSignal( uint32_t portNum, uint32_t bitPosi, void *arg );
+void GPIOIrqPostMessage( uint32_t portNum, uint32_t bitPosi, void *arg );
+#endif
 
 #endif /* end __GPIO_H */
 /*****************************************************************************
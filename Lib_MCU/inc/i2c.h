@@ -57,6 +57,11 @@ extern uint32_t I2CStop( void );
 extern uint32_t I2CEngine( void );
 void I2CRead(uint8_t addr, uint8_t *buf, uint32_t len);
 void I2CWrite(uint8_t addr, uint8_t *buf, uint32_t len);
+void I2CWriteRead(uint8_t addr, uint8_t *wbuf, uint32_t wlen,
+                  uint8_t *rbuf, uint32_t rlen);
+uint32_t I2CProbe(uint8_t addr);
+extern void I2CLock( void );
+extern void I2CUnlock( void );
 
 #endif /* end __I2C_H */
 /****************************************************************************
@@ -0,0 +1,42 @@
+/*****************************************************************************
+ *   logger.h:  Header file for the deferred logger
+ *
+ *   History
+ *   2016.10.19  ver 1.00    First Release
+ *
+******************************************************************************/
+#ifndef __LOGGER_H
+#define __LOGGER_H
+
+#define LOG_ENTRIES		16		/* ring size, must be a power of two */
+#define LOG_MAX_ARGS	4
+#define LOG_LINE_SIZE	96		/* longest formatted line */
+#define LOG_FLUSH_MS	50		/* drain period when the ring is quiet */
+#define LOG_SIGNAL		0x01
+
+#if (LOG_ENTRIES & (LOG_ENTRIES - 1))
+#error LOG_ENTRIES must be a power of two
+#endif
+
+/*
+ * Only the format pointer and up to four 32-bit arguments are recorded,
+ * the string is formatted later by the logger thread. The format and any
+ * %s argument must therefore stay valid (string literals), and arguments
+ * must be integers or pointers - no %f.
+ */
+#define LOG0(fmt)					LOGWrite((fmt), 0, 0, 0, 0)
+#define LOG1(fmt, a)				LOGWrite((fmt), (uint32_t)(a), 0, 0, 0)
+#define LOG2(fmt, a, b)				LOGWrite((fmt), (uint32_t)(a), (uint32_t)(b), 0, 0)
+#define LOG3(fmt, a, b, c)			LOGWrite((fmt), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), 0)
+#define LOG4(fmt, a, b, c, d)		LOGWrite((fmt), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+
+typedef void (*LOGSink)(uint8_t *buffer, uint32_t length);
+
+extern void LOGInit( LOGSink sink );
+extern void LOGWrite( const char *fmt, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3 );
+extern void LOGFlush( void );
+extern uint32_t LOGGetDropped( void );
+#endif /* end __LOGGER_H */
+/*****************************************************************************
+**                            End Of File
+******************************************************************************/
@@ -107,6 +107,42 @@ extern void SSP_IRQHandler (void);
 extern void SSPInit( void );
 extern void SSPSend( uint8_t *Buf, uint32_t Length );
 extern void SSPReceive( uint8_t *buf, uint32_t Length );
+extern void SSPLock( void );
+extern void SSPUnlock( void );
+
+/* Per driver statistics of the SSP port. The drivers select their client
+number when they assert their chip select; transfers are counted for the
+selected client. Set SSP_STATS to 0 to compile the accounting out. */
+#define SSP_STATS			1
+
+#define SSP_CLIENT_OTHER	0
+#define SSP_CLIENT_OLED		1
+#define SSP_CLIENT_LED7		2
+#define SSP_CLIENT_FLASH	3
+#define SSP_CLIENTS			4
+
+typedef struct
+{
+  uint32_t selects;				/* chip select assertions */
+  uint32_t transfers;			/* SSPSend/SSPReceive calls */
+  uint32_t bytes;				/* bytes sent and received */
+  uint32_t cycles;				/* core cycles spent transferring */
+} SSPStats;
+
+/* called after every transfer, in the context of the caller. The cycles
+here and in SSPStats are read from the DWT cycle counter, which must be
+enabled first (cycles_init in the examples); otherwise they are 0. */
+typedef void (*SSPProfileHook)( uint32_t client, uint32_t bytes, uint32_t cycles );
+
+#if SSP_STATS
+extern void SSPSelect( uint32_t client );
+#else
+#define SSPSelect(client)
+#endif
+extern void SSPGetStats( uint32_t client, SSPStats *stats );
+extern void SSPResetStats( void );
+extern void SSPSetProfileHook( SSPProfileHook hook );
+extern void SSPDumpStats( void );
 
 #endif  /* __SSP_H__ */
 /*****************************************************************************
@@ -13,7 +13,8 @@
 
 
 #define RS485_ENABLED		0
-#define TX_INTERRUPT		0		/* 0 if TX uses polling, 1 interrupt driven. */
+#define TX_INTERRUPT		1		/* 0 if TX uses polling, 1 interrupt driven. */
+#define UART_RETARGET_STDOUT	0		/* 1 routes printf (IAR __write) to the UART */
 
 #define IER_RBR		0x01
 #define IER_THRE	0x02
@@ -36,6 +37,15 @@
 
 #define BUFSIZE		0x40
 
+/* Interrupt driven ring buffers. Sizes must be a power of two. */
+#define UART_TX_BUFSIZE	0x80
+#define UART_RX_BUFSIZE	BUFSIZE
+#define UART_FIFO_SIZE	16
+
+#if (UART_TX_BUFSIZE & (UART_TX_BUFSIZE - 1)) || (UART_RX_BUFSIZE & (UART_RX_BUFSIZE - 1))
+#error UART ring buffer sizes must be a power of two
+#endif
+
 /* RS485 mode definition. */
 #define RS485_NMMEN		(0x1<<0)
 #define RS485_RXDIS		(0x1<<1)
@@ -49,7 +59,13 @@ void UARTInit(uint32_t Baudrate);
 void UART_IRQHandler(void);
 void UARTSend(uint8_t *BufferPtr, uint32_t Length);
 void UARTSendString(uint8_t *string);
+uint32_t UARTWrite(uint8_t *buffer, uint32_t length, uint32_t blocking);
+void UARTSetTxBlocking(uint32_t blocking);
+void UARTFlush(void);
 uint32_t UARTReceive(uint8_t *buffer, uint32_t length, uint32_t blocking);
+uint32_t UARTReceiveTimeout(uint8_t *buffer, uint32_t length, uint32_t millisec);
+uint32_t UARTGetRxOverflow(void);
+uint32_t UARTGetTxDropped(void);
 
 #endif /* end __UART_H */
 /*****************************************************************************
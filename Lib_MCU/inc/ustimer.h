@@ -0,0 +1,38 @@
+/*****************************************************************************
+ *   ustimer.h:  Header file for the microsecond timer service
+ *
+ *   History
+ *   2016.10.19  ver 1.00    First Release
+ *
+******************************************************************************/
+#ifndef __USTIMER_H 
+#define __USTIMER_H
+
+#define USTIMER_SIGNAL	0x8000		/* thread signal used by osDelayUs */
+
+typedef void (*USTimerCallback)( void *arg );
+
+/* Caller owned timer node, must stay valid while the timer is active */
+typedef struct USTimer
+{
+  struct USTimer *next;
+  uint32_t deadline;			/* absolute time in us */
+  uint32_t period;				/* 0 for one-shot */
+  USTimerCallback callback;		/* runs in interrupt context */
+  void *arg;
+  volatile uint8_t active;
+} USTimer;
+
+extern void USTimerInit( void );
+extern uint32_t USTimerRunning( void );
+extern uint32_t USTimerNow( void );
+extern void USTimerStart( USTimer *timer, uint32_t delayInUs, uint32_t periodInUs,
+                          USTimerCallback callback, void *arg );
+extern void USTimerStop( USTimer *timer );
+extern void osDelayUs( uint32_t delayInUs );
+extern void TIMER32_1_IRQHandler( void );
+
+#endif /* end __USTIMER_H */
+/*****************************************************************************
+**                            End Of File
+******************************************************************************/
@@ -18,6 +18,72 @@ volatile uint32_t ADCIntDone = 0;
 volatile uint32_t channel_flag; 
 #endif
 
+#if ADC_STREAM
+#include "cmsis_os.h"
+
+static uint16_t *streamBuf;			/* two halves of streamHalf samples */
+static uint32_t streamHalf;			/* samples per half, all channels */
+static uint32_t streamSamples;		/* samples per channel per half */
+static uint8_t  streamChan[ADC_NUM];	/* selected channels, ascending */
+static uint32_t streamNumChan;
+static uint32_t streamIndex;		/* next sample slot in the filling half */
+static uint32_t streamFill;			/* half being filled, 0 or 1 */
+static volatile int32_t streamReady = -1;	/* completed half not yet taken */
+static volatile uint32_t streamOverrun;
+static osThreadId streamConsumer;
+static int32_t streamSignal;
+#if ADC_STREAM_JITTER
+static ADCJitter streamJitter;
+#endif
+
+/******************************************************************************
+** Function name:		ADC_IRQHandler
+**
+** Descriptions:		ADC interrupt handler for stream mode. Runs once
+**						per scan (burst) or per trigger (timer match) and
+**						stores one sample of every selected channel.
+**
+** parameters:			None
+** Returned value:		None
+** 
+******************************************************************************/
+void ADC_IRQHandler (void) 
+{
+  uint16_t *half;
+  uint32_t i;
+
+#if ADC_STREAM_JITTER
+  ADCJitterAdd(&streamJitter, DWT->CYCCNT);
+#endif
+  half = streamBuf + streamFill * streamHalf;
+  for ( i = 0; i < streamNumChan; i++ )
+  {
+	/* reading DR clears its DONE flag and the interrupt */
+	half[i * streamSamples + streamIndex] =
+	  ( LPC_ADC->DR[streamChan[i]] >> 6 ) & 0x3FF;
+  }
+
+  if ( ++streamIndex < streamSamples )
+  {
+	return;
+  }
+
+  /* half full, hand it over and continue in the other one */
+  if ( streamReady >= 0 )
+  {
+	streamOverrun++;		/* consumer did not take the previous half */
+  }
+  streamReady = streamFill;
+  streamFill ^= 1;
+  streamIndex = 0;
+  if ( streamConsumer != NULL )
+  {
+	osSignalSet(streamConsumer, streamSignal);
+  }
+  return;
+}
+#endif
+
 #if ADC_INTERRUPT_FLAG
 /******************************************************************************
 ** Function name:		ADC_IRQHandler
@@ -258,6 +324,317 @@ void ADCBurstRead( void )
 								handler, return 0. */
 }
 
+#if ADC_STREAM
+/*****************************************************************************
+** Function name:		adcStreamTimer
+**
+** Descriptions:		Program the match that triggers a conversion at
+**						rate Hz. The match output toggles, the ADC starts
+**						on its rising edge, so the match runs at 2*rate.
+**
+** parameters:			trigger, rate
+** Returned value:		Actual trigger rate
+** 
+*****************************************************************************/
+static uint32_t adcStreamTimer( uint8_t trigger, uint32_t rate )
+{
+  LPC_TMR_TypeDef *tmr;
+  uint32_t pclk = SystemCoreClock/LPC_SYSCON->SYSAHBCLKDIV;
+  uint32_t ticks, prescale, match;
+  uint32_t mat = ( trigger == ADC_TRIG_CT32B0_MAT1 || trigger == ADC_TRIG_CT16B0_MAT1 ) ? 1 : 0;
+
+  if ( trigger <= ADC_TRIG_CT32B0_MAT1 )
+  {
+	tmr = LPC_TMR32B0;
+	LPC_SYSCON->SYSAHBCLKCTRL |= (1<<9);
+	prescale = 0;
+  }
+  else
+  {
+	tmr = LPC_TMR16B0;
+	LPC_SYSCON->SYSAHBCLKCTRL |= (1<<7);
+	prescale = (pclk / (2 * rate)) >> 16;	/* keep the match inside 16 bits */
+  }
+  ticks = pclk / (2 * rate);
+  match = ticks / (prescale + 1);
+  if ( match == 0 )
+  {
+	match = 1;
+  }
+
+  tmr->TCR = 0x02;				/* reset and hold */
+  tmr->PR  = prescale;
+  tmr->MR0 = match - 1;
+  tmr->MR1 = match - 1;
+  tmr->MCR = 0x02 << (3 * mat);	/* reset on MRx, no interrupt */
+  tmr->EMR = (0x3 << (4 + 2 * mat));	/* toggle EMx on match */
+  tmr->TCR = 0x01;
+
+  return pclk / (2 * match * (prescale + 1));
+}
+
+/*****************************************************************************
+** Function name:		ADCStreamStart
+**
+** Descriptions:		Start continuous acquisition into a ping-pong
+**						buffer. buffer holds two halves; each half keeps
+**						samples values per selected channel, channel by
+**						channel in ascending channel order. When a half
+**						is full, signal is set on the consumer thread.
+**
+**						ADC_TRIG_BURST scans all selected channels back
+**						to back; rate (scans/s) is approximated through
+**						the ADC clock divider, which cannot go below
+**						about 25k conversions/s. The timer triggers give
+**						exact rates down to a few Hz but convert a
+**						single channel, the lowest one in channelMask.
+**						ADCInit must be called first.
+**
+** parameters:			buffer (2 * samples * channels entries), samples
+**						per channel per half, channel mask, rate,
+**						trigger, consumer osThreadId, signal
+** Returned value:		Actual scan rate in Hz
+** 
+*****************************************************************************/
+uint32_t ADCStreamStart( uint16_t *buffer, uint32_t samples, uint8_t channelMask,
+                         uint32_t rate, uint8_t trigger,
+                         void *consumer, int32_t signal )
+{
+  uint32_t pclk = SystemCoreClock/LPC_SYSCON->SYSAHBCLKDIV;
+  uint32_t clkdiv, actual;
+  uint32_t i;
+
+  ADCStreamStop();
+  if ( buffer == NULL || samples == 0 || channelMask == 0 || rate == 0 )
+  {
+	return 0;
+  }
+
+  if ( trigger != ADC_TRIG_BURST )
+  {
+	channelMask &= -channelMask;	/* software mode converts one channel */
+  }
+  streamNumChan = 0;
+  for ( i = 0; i < ADC_NUM; i++ )
+  {
+	if ( channelMask & (1 << i) )
+	{
+	  streamChan[streamNumChan++] = i;
+	}
+  }
+
+  streamBuf = buffer;
+  streamSamples = samples;
+  streamHalf = samples * streamNumChan;
+  streamIndex = 0;
+  streamFill = 0;
+  streamReady = -1;
+  streamOverrun = 0;
+  streamConsumer = (osThreadId)consumer;
+  streamSignal = signal;
+#if ADC_STREAM_JITTER
+  ADCJitterInit(&streamJitter, 0);
+#endif
+
+  /* interrupt on the last channel of a scan only */
+  LPC_ADC->INTEN = 1 << streamChan[streamNumChan - 1];
+  NVIC_EnableIRQ(ADC_IRQn);
+
+  if ( trigger == ADC_TRIG_BURST )
+  {
+	/* one conversion takes 11 ADC clocks */
+	clkdiv = pclk / (rate * 11 * streamNumChan);
+	if ( clkdiv == 0 || pclk / clkdiv > ADC_CLK_MAX )
+	{
+	  clkdiv = (pclk + ADC_CLK_MAX - 1) / ADC_CLK_MAX;
+	}
+	if ( clkdiv > 256 )
+	{
+	  clkdiv = 256;
+	}
+	LPC_ADC->CR = channelMask | ((clkdiv - 1) << 8) | (1 << 16) | (1 << 21);
+	actual = pclk / (clkdiv * 11 * streamNumChan);
+  }
+  else
+  {
+	LPC_ADC->CR = (LPC_ADC->CR & 0x0000FF00) | channelMask | (1 << 21) |
+	  ((uint32_t)trigger << 24);		/* EDGE = 0, rising edge */
+	actual = adcStreamTimer(trigger, rate);
+  }
+#if ADC_STREAM_JITTER
+  streamJitter.nominal = SystemCoreClock / actual;
+#endif
+  return actual;
+}
+
+/*****************************************************************************
+** Function name:		ADCStreamStop
+**
+** Descriptions:		Stop continuous acquisition
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+void ADCStreamStop( void )
+{
+  uint32_t trigger = (LPC_ADC->CR >> 24) & 0x7;
+
+  NVIC_DisableIRQ(ADC_IRQn);
+  LPC_ADC->INTEN = 0;
+  LPC_ADC->CR &= ~((0x7 << 24) | (1 << 16));	/* no start, no burst */
+
+  if ( trigger == ADC_TRIG_CT32B0_MAT0 || trigger == ADC_TRIG_CT32B0_MAT1 )
+  {
+	LPC_TMR32B0->TCR = 0;
+  }
+  else if ( trigger == ADC_TRIG_CT16B0_MAT0 || trigger == ADC_TRIG_CT16B0_MAT1 )
+  {
+	LPC_TMR16B0->TCR = 0;
+  }
+  streamConsumer = NULL;
+}
+
+/*****************************************************************************
+** Function name:		ADCStreamGetBuffer
+**
+** Descriptions:		Take the last completed half. The data stays valid
+**						until the ADC wraps around into it again, one
+**						half period later.
+**
+** parameters:			None
+** Returned value:		Pointer to the half, NULL if none is ready
+** 
+*****************************************************************************/
+uint16_t *ADCStreamGetBuffer( void )
+{
+  int32_t ready;
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  ready = streamReady;
+  streamReady = -1;
+  __set_PRIMASK(primask);
+  if ( ready < 0 )
+  {
+	return NULL;
+  }
+  return streamBuf + ready * streamHalf;
+}
+
+/*****************************************************************************
+** Function name:		ADCJitterInit
+**
+** Descriptions:		Clear an interval histogram and start the DWT
+**						cycle counter used for time stamps
+**
+** parameters:			histogram, nominal interval in core cycles
+** Returned value:		None
+** 
+*****************************************************************************/
+void ADCJitterInit( ADCJitter *jitter, uint32_t nominal )
+{
+  uint32_t i;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  jitter->nominal = nominal;
+  jitter->last = 0;
+  jitter->count = 0;
+  jitter->min = 0xFFFFFFFF;
+  jitter->max = 0;
+  for ( i = 0; i < ADC_JITTER_BINS; i++ )
+  {
+	jitter->hist[i] = 0;
+  }
+}
+
+/*****************************************************************************
+** Function name:		ADCJitterAdd
+**
+** Descriptions:		Record the interval between stamp and the
+**						previous time stamp. The first call only
+**						stores the stamp.
+**
+** parameters:			histogram, DWT->CYCCNT time stamp
+** Returned value:		None
+** 
+*****************************************************************************/
+void ADCJitterAdd( ADCJitter *jitter, uint32_t stamp )
+{
+  uint32_t interval;
+  int32_t bin;
+
+  if ( jitter->last != 0 )
+  {
+	interval = stamp - jitter->last;
+	if ( interval < jitter->min )
+	{
+	  jitter->min = interval;
+	}
+	if ( interval > jitter->max )
+	{
+	  jitter->max = interval;
+	}
+	/* offset before dividing, so the division rounds down and every bin,
+	   the centre one included, is ADC_JITTER_BIN_CYCLES wide */
+	bin = ((int32_t)(interval - jitter->nominal)
+	  + ADC_JITTER_BINS / 2 * ADC_JITTER_BIN_CYCLES) / ADC_JITTER_BIN_CYCLES;
+	if ( bin < 0 )
+	{
+	  bin = 0;
+	}
+	else if ( bin >= ADC_JITTER_BINS )
+	{
+	  bin = ADC_JITTER_BINS - 1;
+	}
+	jitter->hist[bin]++;
+	jitter->count++;
+  }
+  jitter->last = stamp | 1;		/* 0 means no stamp yet */
+}
+
+#if ADC_STREAM_JITTER
+/*****************************************************************************
+** Function name:		ADCStreamGetJitter
+**
+** Descriptions:		Copy the sample interval histogram of the
+**						running stream. Intervals are measured at the
+**						ADC interrupt, so they include interrupt latency.
+**
+** parameters:			destination histogram
+** Returned value:		None
+** 
+*****************************************************************************/
+void ADCStreamGetJitter( ADCJitter *jitter )
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *jitter = streamJitter;
+  __set_PRIMASK(primask);
+}
+#endif
+
+/*****************************************************************************
+** Function name:		ADCStreamGetOverrun
+**
+** Descriptions:		Number of halves completed before the consumer
+**						took the previous one
+**
+** parameters:			None
+** Returned value:		Overrun count
+** 
+*****************************************************************************/
+uint32_t ADCStreamGetOverrun( void )
+{
+  return streamOverrun;
+}
+#endif
+
 /*********************************************************************************
 **                            End Of File
 *********************************************************************************/
@@ -18,13 +18,6 @@
  * =================== */
 //#define GPIO_GENERIC_INTS 1
 
-/* Shadow registers used to prevent chance of read-modify-write errors */
-/* Ultra-conservative approach... */
-static uint32_t GPIOShadowPort0;
-static uint32_t GPIOShadowPort1;
-static uint32_t GPIOShadowPort2;
-static uint32_t GPIOShadowPort3;
-
 #ifdef GPIO_GENERIC_INTS
 volatile uint32_t gpio0_counter = 0;
 volatile uint32_t gpio1_counter = 0;
@@ -128,6 +121,186 @@ void PIOINT3_IRQHandler(void)
 }
 #endif //GPIO_GENERIC_INTS
 
+#if GPIO_IRQ_DISPATCH && !defined(GPIO_GENERIC_INTS)
+#include "cmsis_os.h"
+
+typedef struct
+{
+  GPIOIrqCallback callback;
+  void *arg;
+} GPIOIrqEntry;
+
+static GPIOIrqEntry GPIOIrqTable[PORT3 + 1][GPIO_PINS_PER_PORT];
+
+/*****************************************************************************
+** Function name:		GPIOIrqDispatch
+**
+** Descriptions:		Read the masked status of a port once, clear all
+**						pending pins with one write and call the
+**						callback of each pin that fired.
+**
+** parameters:			port num
+** Returned value:		None
+** 
+*****************************************************************************/
+static void GPIOIrqDispatch( uint32_t portNum )
+{
+  LPC_GPIO_TypeDef *port = GPIO_PORT( portNum );
+  GPIOIrqEntry *entry;
+  uint32_t pending;
+  uint32_t bitPosi;
+
+  pending = port->MIS;
+  port->IC = pending;		/* clear first so new edges are not lost */
+
+  while ( pending )
+  {
+	bitPosi = 31 - __CLZ( pending );
+	pending &= ~(0x1<<bitPosi);
+
+	entry = &GPIOIrqTable[portNum][bitPosi];
+	if ( entry->callback )
+	{
+	  entry->callback( portNum, bitPosi, entry->arg );
+	}
+  }
+  return;
+}
+
+/*****************************************************************************
+** Function name:		PIOINTx_IRQHandler
+**
+** Descriptions:		Port interrupt handlers, dispatch to the pin
+**						callbacks installed with GPIOAttachIrq
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+void PIOINT0_IRQHandler(void)
+{
+  GPIOIrqDispatch( PORT0 );
+}
+
+void PIOINT1_IRQHandler(void)
+{
+  GPIOIrqDispatch( PORT1 );
+}
+
+void PIOINT2_IRQHandler(void)
+{
+  GPIOIrqDispatch( PORT2 );
+}
+
+void PIOINT3_IRQHandler(void)
+{
+  GPIOIrqDispatch( PORT3 );
+}
+
+/*****************************************************************************
+** Function name:		GPIOAttachIrq
+**
+** Descriptions:		Configure a pin as edge triggered input and call
+**						callback(port, bit, arg) from the port interrupt
+**						when the selected edge occurs. GPIOInit must have
+**						been called to enable the port interrupts.
+**
+** parameters:			port num, bit position, GPIO_EDGE_xxx, callback,
+**						callback argument
+** Returned value:		None
+** 
+*****************************************************************************/
+void GPIOAttachIrq( uint32_t portNum, uint32_t bitPosi, uint32_t edge,
+			GPIOIrqCallback callback, void *arg )
+{
+  LPC_GPIO_TypeDef *port;
+  uint32_t primask;
+
+  if ( portNum > PORT3 || bitPosi >= GPIO_PINS_PER_PORT )
+  {
+	return;
+  }
+  port = GPIO_PORT( portNum );
+
+  /* IE may also be changed by the callbacks of other pins */
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  port->IE &= ~(0x1<<bitPosi);
+  GPIOIrqTable[portNum][bitPosi].callback = callback;
+  GPIOIrqTable[portNum][bitPosi].arg = arg;
+
+  GPIOSetDir( portNum, bitPosi, 0 );
+  GPIOSetInterrupt( portNum, bitPosi, 0, edge == GPIO_EDGE_BOTH,
+		edge == GPIO_EDGE_RISING );
+  port->IC = (0x1<<bitPosi);
+  port->IE |= (0x1<<bitPosi);
+
+  __set_PRIMASK( primask );
+  return;
+}
+
+/*****************************************************************************
+** Function name:		GPIODetachIrq
+**
+** Descriptions:		Disable the interrupt of a pin and drop its
+**						callback
+**
+** parameters:			port num, bit position
+** Returned value:		None
+** 
+*****************************************************************************/
+void GPIODetachIrq( uint32_t portNum, uint32_t bitPosi )
+{
+  uint32_t primask;
+
+  if ( portNum > PORT3 || bitPosi >= GPIO_PINS_PER_PORT )
+  {
+	return;
+  }
+  primask = __get_PRIMASK();
+  __disable_irq();
+  GPIO_PORT( portNum )->IE &= ~(0x1<<bitPosi);
+  GPIOIrqTable[portNum][bitPosi].callback = 0;
+  GPIOIrqTable[portNum][bitPosi].arg = 0;
+  __set_PRIMASK( primask );
+  return;
+}
+
+/*****************************************************************************
+** Function name:		GPIOIrqPostSignal
+**
+** Descriptions:		Stock callback: set the signals of a thread. arg
+**						points to a GPIOIrqSignal.
+**
+** parameters:			port num, bit position, GPIOIrqSignal pointer
+** Returned value:		None
+** 
+*****************************************************************************/
+void GPIOIrqPostSignal( uint32_t portNum, uint32_t bitPosi, void *arg )
+{
+  GPIOIrqSignal *sig = (GPIOIrqSignal *)arg;
+
+  osSignalSet( (osThreadId)sig->thread, sig->signals );
+}
+
+/*****************************************************************************
+** Function name:		GPIOIrqPostMessage
+**
+** Descriptions:		Stock callback: put GPIO_IRQ_MSG(port, bit) in a
+**						message queue. arg is the osMessageQId. The
+**						message is dropped if the queue is full.
+**
+** parameters:			port num, bit position, message queue
+** Returned value:		None
+** 
+*****************************************************************************/
+void GPIOIrqPostMessage( uint32_t portNum, uint32_t bitPosi, void *arg )
+{
+  osMessagePut( (osMessageQId)arg, GPIO_IRQ_MSG( portNum, bitPosi ), 0 );
+}
+#endif
+
 /*****************************************************************************
 ** Function name:		GPIOInit
 **
@@ -155,11 +328,6 @@ void GPIOInit( void )
   NVIC_EnableIRQ(EINT1_IRQn);
   NVIC_EnableIRQ(EINT2_IRQn);
   NVIC_EnableIRQ(EINT3_IRQn);
-
-  GPIOShadowPort0 = LPC_GPIO0->DATA;
-  GPIOShadowPort1 = LPC_GPIO1->DATA;
-  GPIOShadowPort2 = LPC_GPIO2->DATA;
-  GPIOShadowPort3 = LPC_GPIO3->DATA;
   return;
 }
 
@@ -215,11 +383,10 @@ void GPIOSetDir( uint32_t portNum, uint32_t bitPosi, uint32_t dir )
 ** Function name:		GPIOSetValue
 **
 ** Descriptions:		Set/clear a bitvalue in a specific bit position
-**						in GPIO portX(X is the port number.) Because of the
-**						implementation of port shadowing to prevent GPIO errors
-**						under external cap load it is important to only use
-**						this function for GPIO or to remove it and use your own
-**						GPIO routines.
+**						in GPIO portX(X is the port number.) The write
+**						goes through the masked access window, so only
+**						the selected pin changes and there is no
+**						read-modify-write of the port.
 **
 ** parameters:			port num, bit position, bit value
 ** Returned value:		None
@@ -227,52 +394,11 @@ void GPIOSetDir( uint32_t portNum, uint32_t bitPosi, uint32_t dir )
 *****************************************************************************/
 void GPIOSetValue( uint32_t portNum, uint32_t bitPosi, uint32_t bitVal )
 {
-   /* if bitVal is 1, the bitPosi bit is set in the GPIOShadowPortx. Then
-    * GPIOShadowPortx is written to the I/O port register. */
-
-  switch ( portNum )
+  if ( portNum > PORT3 )
   {
-	case PORT0:
-		 if(bitVal)
-			 GPIOShadowPort0 |= (1<<bitPosi);
-		 else
-			 GPIOShadowPort0 &= ~(1<<bitPosi);
-
-		 /* Use of shadow prevents bit operation error if the read value
-		  * (external hardware state) of a pin differs from the I/O latch
-		  * value. A potential side effect is that other GPIO code in this
-		  * project that is not aware of the shadow will have its GPIO
-		  * state overwritten.
-		  */
-		 LPC_GPIO0->DATA = GPIOShadowPort0;
-	break;
- 	case PORT1:
-		 if(bitVal)
-			 GPIOShadowPort1 |= (1<<bitPosi);
-		 else
-			 GPIOShadowPort1 &= ~(1<<bitPosi);
-
-		 LPC_GPIO1->DATA = GPIOShadowPort1;
-	break;
-	case PORT2:
-		 if(bitVal)
-			 GPIOShadowPort2 |= (1<<bitPosi);
-		 else
-			 GPIOShadowPort2 &= ~(1<<bitPosi);
-
-		 LPC_GPIO2->DATA = GPIOShadowPort2;
-	break;
-	case PORT3:
-		 if(bitVal)
-			 GPIOShadowPort3 |= (1<<bitPosi);
-		 else
-			 GPIOShadowPort3 &= ~(1<<bitPosi);
-
-		 LPC_GPIO3->DATA = GPIOShadowPort3;
-	break;
-	default:
-	  break;
+	return;
   }
+  GPIOPinWrite( GPIO_PIN( portNum, bitPosi ), bitVal );
   return;
 }
 
@@ -10,6 +10,7 @@
 *****************************************************************************/
 #include "mcu_regs.h"
 #include "type.h"
+#include "cmsis_os.h"
 #include "i2c.h"
 
 static volatile uint32_t I2CMasterState = I2C_IDLE;
@@ -26,6 +27,13 @@ static volatile uint32_t I2CWriteLength;
 static volatile uint32_t RdIndex = 0;
 static volatile uint32_t WrIndex = 0;
 static volatile uint8_t I2CAddr;
+static volatile uint32_t I2CAddrNack;
+
+/* The transfer parameters above and the state machine are shared by all
+devices on the bus; a transfer holds this mutex from setting them up until
+the stop condition. */
+osMutexDef(i2c_mutex);
+static osMutexId i2cMutex = NULL;
 
 /* 
 From device to device, the I2C communication protocol may vary, 
@@ -65,7 +73,7 @@ void I2C_IRQHandler(void)
 	case 0x10:			/* A repeated started is issued */
 	RdIndex = 0;
 	/* Send SLA with R bit set, */
-    LPC_I2C->DAT = I2CAddr;
+    LPC_I2C->DAT = I2CAddr | RD_BIT;
 	LPC_I2C->CONCLR = (I2CONCLR_SIC | I2CONCLR_STAC);
 	I2CMasterState = I2C_RESTARTED;
 	break;
@@ -73,8 +81,17 @@ void I2C_IRQHandler(void)
 	case 0x18:			/* Regardless, it's a ACK */
 	if ( I2CMasterState == I2C_STARTED )
 	{
-	  LPC_I2C->DAT = I2CMasterBuffer[WrIndex++];
-	  I2CMasterState = DATA_ACK;
+	  if ( I2CWriteLength != 0 )
+	  {
+		LPC_I2C->DAT = I2CMasterBuffer[WrIndex++];
+		I2CMasterState = DATA_ACK;
+	  }
+	  else
+	  {
+		/* Address only transfer, see I2CProbe */
+		I2CMasterState = DATA_NACK;
+		LPC_I2C->CONSET = I2CONSET_STO;
+	  }
 	}
 	LPC_I2C->CONCLR = I2CONCLR_SIC;
 	break;
@@ -118,14 +135,15 @@ void I2C_IRQHandler(void)
 	
 	case 0x50:	/* Data byte has been received, regardless following ACK or NACK */
 	I2CSlaveBuffer[RdIndex++] = LPC_I2C->DAT;
-	if ( RdIndex < I2CReadLength )
+	/* AA applies to the byte being received next: NACK it if it is the
+	last one, the transfer then ends in state 0x58. */
+	I2CMasterState = DATA_ACK;
+	if ( RdIndex + 1 < I2CReadLength )
 	{   
-	  I2CMasterState = DATA_ACK;
 	  LPC_I2C->CONSET = I2CONSET_AA;	/* assert ACK after data is received */
 	}
 	else
 	{
-	  I2CMasterState = DATA_NACK;
 	  LPC_I2C->CONCLR = I2CONCLR_AAC;	/* assert NACK on last byte */
 	}
 	LPC_I2C->CONCLR = I2CONCLR_SIC;
@@ -140,6 +158,7 @@ void I2C_IRQHandler(void)
 
 	case 0x20:		/* regardless, it's a NACK */
 	case 0x48:
+	I2CAddrNack = 1;
 	LPC_I2C->CONCLR = I2CONCLR_SIC;
 	I2CMasterState = DATA_NACK;
 	break;
@@ -261,9 +280,50 @@ uint32_t I2CInit( uint32_t I2cMode, uint32_t slaveAddr )
   NVIC_EnableIRQ(I2C_IRQn);
 
   LPC_I2C->CONSET = I2CONSET_I2EN;
+
+  if ( i2cMutex == NULL )
+  {
+	i2cMutex = osMutexCreate( osMutex(i2c_mutex) );
+  }
   return( TRUE );
 }
 
+/*****************************************************************************
+** Function name:		I2CLock
+**
+** Descriptions:		Get exclusive use of the I2C bus. Calls may be
+**				nested. Does nothing while the kernel is not
+**				running.
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+void I2CLock( void )
+{
+  if ( osKernelRunning() && i2cMutex != NULL )
+  {
+	osMutexWait( i2cMutex, osWaitForever );
+  }
+}
+
+/*****************************************************************************
+** Function name:		I2CUnlock
+**
+** Descriptions:		Release the I2C bus
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+void I2CUnlock( void )
+{
+  if ( osKernelRunning() && i2cMutex != NULL )
+  {
+	osMutexRelease( i2cMutex );
+  }
+}
+
 /*****************************************************************************
 ** Function name:		I2CEngine
 **
@@ -283,50 +343,117 @@ uint32_t I2CInit( uint32_t I2cMode, uint32_t slaveAddr )
 *****************************************************************************/
 uint32_t I2CEngine( void )
 {
+  uint32_t result = TRUE;
+
+  I2CLock();
   I2CMasterState = I2C_IDLE;
+  I2CAddrNack = 0;
   RdIndex = 0;
   WrIndex = 0;
   if ( I2CStart() != TRUE )
   {
 	I2CStop();
-	return ( FALSE );
+	result = FALSE;
   }
-
-  while ( 1 )
+  else
   {
-	if ( I2CMasterState == DATA_NACK )
+	while ( 1 )
 	{
-	  I2CStop();
-	  break;
+	  if ( I2CMasterState == DATA_NACK )
+	  {
+		I2CStop();
+		break;
+	  }
 	}
-  }    
-  return ( TRUE );      
+  }
+  I2CUnlock();
+  return ( result );      
 }
 
 void I2CRead(uint8_t addr, uint8_t *buf, uint32_t len)
 {
+    I2CLock();
     I2CAddr = addr | RD_BIT;
     I2CSlaveBuffer = buf;
     I2CReadLength = len;
     I2CWriteLength = 1;
 
     I2CEngine();
+    I2CUnlock();
 
     I2CReadLength = I2CReadLength;
 }
 
 void I2CWrite(uint8_t addr, uint8_t* buf, uint32_t len)
 {
+    I2CLock();
     I2CAddr = addr;
     I2CMasterBuffer = buf;
     I2CWriteLength = len;
     I2CReadLength = 0;
 
     I2CEngine();
+    I2CUnlock();
 
     I2CWriteLength = I2CWriteLength;
 }
 
+/*****************************************************************************
+** Function name:		I2CWriteRead
+**
+** Descriptions:		Write wlen bytes, then read rlen bytes after a
+**				repeated start, in one transaction:
+**				STA,Addr(W),data...,RE-STA,Addr(R),data...STO
+**				Typically used to set a register pointer and
+**				read a block of auto-incremented registers.
+**
+** parameters:			address, write buffer and length, read buffer
+**				and length
+** Returned value:		None
+** 
+*****************************************************************************/
+void I2CWriteRead(uint8_t addr, uint8_t *wbuf, uint32_t wlen,
+                  uint8_t *rbuf, uint32_t rlen)
+{
+    I2CLock();
+    I2CAddr = addr & ~RD_BIT;
+    I2CMasterBuffer = wbuf;
+    I2CWriteLength = wlen;
+    I2CSlaveBuffer = rbuf;
+    I2CReadLength = rlen;
+
+    I2CEngine();
+    I2CUnlock();
+}
+
+/*****************************************************************************
+** Function name:		I2CProbe
+**
+** Descriptions:		Address the device for writing and stop right
+**				after the address byte: STA,Addr(W),STO.
+**				A device busy with an internal write cycle,
+**				like a serial EEPROM, does not acknowledge its
+**				address, so this is used for ACK polling.
+**
+** parameters:			address
+** Returned value:		TRUE if the device acknowledged its address
+** 
+*****************************************************************************/
+uint32_t I2CProbe(uint8_t addr)
+{
+    uint32_t acked;
+
+    I2CLock();
+    I2CAddr = addr & ~RD_BIT;
+    I2CWriteLength = 0;
+    I2CReadLength = 0;
+
+    acked = ( I2CEngine() == TRUE && !I2CAddrNack ) ? TRUE : FALSE;
+    I2CUnlock();
+
+    return ( acked );
+}
+
 /******************************************************************************
 **                            End Of File
 ******************************************************************************/
@@ -0,0 +1,189 @@
+/*****************************************************************************
+ *   logger.c:  Deferred printf style logger
+ *
+ *   LOGWrite only reserves a ring slot and stores the format pointer and
+ *   raw arguments. A low priority thread formats the entries and hands
+ *   the text to the sink (UARTSend by default), so the caller never pays
+ *   for formatting or transmission.
+ *
+ *   History
+ *   2016.10.19  ver 1.00    First Release
+ *
+******************************************************************************/
+#include <stdio.h>
+#include "mcu_regs.h"
+#include "cmsis_os.h"
+#include "uart.h"
+#include "logger.h"
+
+#define LOG_MASK	(LOG_ENTRIES - 1)
+
+typedef struct {
+    const char *fmt;
+    uint32_t arg[LOG_MAX_ARGS];
+    volatile uint32_t ready;
+} LOGEntry;
+
+static LOGEntry logRing[LOG_ENTRIES];
+static volatile uint32_t logHead = 0;	/* next slot to reserve, producers */
+static volatile uint32_t logTail = 0;	/* next slot to format, logger thread */
+static volatile uint32_t logDropped = 0;
+static char logLine[LOG_LINE_SIZE];
+static LOGSink logSink = NULL;
+static osThreadId logThreadId = NULL;
+
+static void logUartSink(uint8_t *buffer, uint32_t length)
+{
+    UARTSend(buffer, length);
+}
+
+/* Format and emit everything that is ready, in order. */
+static void logDrain(void)
+{
+    LOGEntry *e;
+    int len;
+
+    while (logTail != logHead)
+    {
+        e = &logRing[logTail & LOG_MASK];
+        if (!e->ready)
+        {
+            break;		/* slot reserved but still being filled */
+        }
+
+        len = snprintf(logLine, sizeof(logLine), e->fmt,
+                       e->arg[0], e->arg[1], e->arg[2], e->arg[3]);
+        __DMB();
+        e->ready = 0;
+        logTail++;
+
+        if (len > 0)
+        {
+            if (len >= (int)sizeof(logLine))
+            {
+                len = sizeof(logLine) - 1;
+            }
+            logSink((uint8_t *)logLine, len);
+        }
+    }
+}
+
+static void loggerThread(void const *args)
+{
+    while (1)
+    {
+        osSignalWait(LOG_SIGNAL, LOG_FLUSH_MS);
+        logDrain();
+    }
+}
+osThreadDef(loggerThread, osPriorityLow, 1, 0);
+
+/*****************************************************************************
+** Function name:		LOGInit
+**
+** Descriptions:		Set the output sink and start the logger thread.
+**						A NULL sink sends the text to the UART, which
+**						must be initialized by the caller.
+**
+** parameters:			sink
+** Returned value:		None
+**
+*****************************************************************************/
+void LOGInit( LOGSink sink )
+{
+    logSink = (sink != NULL) ? sink : logUartSink;
+
+    if (logThreadId == NULL)
+    {
+        logThreadId = osThreadCreate(osThread(loggerThread), NULL);
+    }
+}
+
+/*****************************************************************************
+** Function name:		LOGWrite
+**
+** Descriptions:		Record a log entry. Safe from threads and
+**						interrupts; never blocks. When the ring is full
+**						the entry is dropped and counted.
+**
+** parameters:			format string, four 32-bit arguments
+** Returned value:		None
+**
+*****************************************************************************/
+void LOGWrite( const char *fmt, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3 )
+{
+    LOGEntry *e;
+    uint32_t head;
+    uint32_t count;
+
+    /* reserve a slot, lock free across threads and ISRs */
+    do
+    {
+        head = __LDREXW((uint32_t *)&logHead);
+        if (head - logTail >= LOG_ENTRIES)
+        {
+            __CLREX();
+            do
+            {
+                count = __LDREXW((uint32_t *)&logDropped);
+            } while (__STREXW(count + 1, (uint32_t *)&logDropped));
+            return;
+        }
+    } while (__STREXW(head + 1, (uint32_t *)&logHead));
+
+    e = &logRing[head & LOG_MASK];
+    e->fmt = fmt;
+    e->arg[0] = a0;
+    e->arg[1] = a1;
+    e->arg[2] = a2;
+    e->arg[3] = a3;
+    __DMB();
+    e->ready = 1;
+
+    /* wake the logger early once the ring is half full */
+    if (head - logTail == LOG_ENTRIES / 2 && logThreadId != NULL)
+    {
+        osSignalSet(logThreadId, LOG_SIGNAL);
+    }
+}
+
+/*****************************************************************************
+** Function name:		LOGFlush
+**
+** Descriptions:		Wake the logger thread and wait until every
+**						pending entry has been emitted
+**
+** parameters:			None
+** Returned value:		None
+**
+*****************************************************************************/
+void LOGFlush( void )
+{
+    if (logThreadId == NULL)
+    {
+        return;
+    }
+    while (logTail != logHead)
+    {
+        osSignalSet(logThreadId, LOG_SIGNAL);
+        osDelay(1);
+    }
+}
+
+/*****************************************************************************
+** Function name:		LOGGetDropped
+**
+** Descriptions:		Number of entries lost because the ring was full
+**
+** parameters:			None
+** Returned value:		Dropped entry count
+**
+*****************************************************************************/
+uint32_t LOGGetDropped( void )
+{
+    return logDropped;
+}
+
+/******************************************************************************
+**                            End Of File
+******************************************************************************/
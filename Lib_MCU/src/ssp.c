@@ -9,7 +9,11 @@
  *
 *****************************************************************************/
 #include "mcu_regs.h"
+#include "stdio.h"
+#include "string.h"
 #include "gpio.h"
+#include "cmsis_os.h"
+#include "uart.h"
 #include "ssp.h"
 
 /* statistics of all the interrupts */
@@ -17,6 +21,30 @@ volatile uint32_t interruptRxStat = 0;
 volatile uint32_t interruptOverRunStat = 0;
 volatile uint32_t interruptRxTimeoutStat = 0;
 
+/* The SSP port is shared by the OLED, the dataflash and the 7-segment
+display; drivers hold this mutex while their chip select is asserted. */
+osMutexDef(ssp_mutex);
+static osMutexId sspMutex = NULL;
+
+#if SSP_STATS
+static SSPStats sspStats[SSP_CLIENTS];
+static uint32_t sspClient = SSP_CLIENT_OTHER;
+static SSPProfileHook sspHook = NULL;
+
+static void SSPAccount( uint32_t bytes, uint32_t cycles )
+{
+  SSPStats *stats = &sspStats[sspClient];
+
+  stats->transfers++;
+  stats->bytes += bytes;
+  stats->cycles += cycles;
+  if ( sspHook != NULL )
+  {
+	sspHook( sspClient, bytes, cycles );
+  }
+}
+#endif
+
 /*****************************************************************************
 ** Function name:		SSP_IRQHandler
 **
@@ -147,6 +175,11 @@ void SSPInit( void )
   /* enable all error related interrupts */
   //DR:
   LPC_SSP0->IMSC = SSPIMSC_RORIM | SSPIMSC_RTIM;
+
+  if ( sspMutex == NULL )
+  {
+	sspMutex = osMutexCreate( osMutex(ssp_mutex) );
+  }
   return;
 }
 
@@ -165,6 +198,9 @@ void SSPSend( uint8_t *buf, uint32_t Length )
 {
   uint32_t i;
   uint8_t Dummy = Dummy;
+#if SSP_STATS
+  uint32_t start = DWT->CYCCNT;
+#endif
     
   for ( i = 0; i < Length; i++ )
   {
@@ -186,6 +222,9 @@ void SSPSend( uint8_t *buf, uint32_t Length )
 	while ( LPC_SSP->SR & SSPSR_BSY );
 #endif
   }
+#if SSP_STATS
+  SSPAccount( Length, DWT->CYCCNT - start );
+#endif
   return; 
 }
 
@@ -201,6 +240,9 @@ void SSPSend( uint8_t *buf, uint32_t Length )
 void SSPReceive( uint8_t *buf, uint32_t Length )
 {
   uint32_t i;
+#if SSP_STATS
+  uint32_t start = DWT->CYCCNT;
+#endif
  
   for ( i = 0; i < Length; i++ )
   {
@@ -226,9 +268,154 @@ void SSPReceive( uint8_t *buf, uint32_t Length )
 	buf++;
 	
   }
+#if SSP_STATS
+  SSPAccount( Length, DWT->CYCCNT - start );
+#endif
   return; 
 }
 
+/*****************************************************************************
+** Function name:		SSPLock
+**
+** Descriptions:		Get exclusive use of the SSP port. Calls may be
+**						nested. Does nothing while the kernel is not
+**						running.
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+void SSPLock( void )
+{
+  if ( osKernelRunning() && sspMutex != NULL )
+  {
+	osMutexWait( sspMutex, osWaitForever );
+  }
+}
+
+/*****************************************************************************
+** Function name:		SSPUnlock
+**
+** Descriptions:		Release the SSP port
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+void SSPUnlock( void )
+{
+  if ( osKernelRunning() && sspMutex != NULL )
+  {
+	osMutexRelease( sspMutex );
+  }
+}
+
+#if SSP_STATS
+/*****************************************************************************
+** Function name:		SSPSelect
+**
+** Descriptions:		Count a chip select assertion and account the
+**						following transfers to the client. Called by
+**						the drivers with the SSP port locked.
+**
+** parameters:			client number, SSP_CLIENT_xxx
+** Returned value:		None
+** 
+*****************************************************************************/
+void SSPSelect( uint32_t client )
+{
+  if ( client >= SSP_CLIENTS )
+  {
+	client = SSP_CLIENT_OTHER;
+  }
+  sspClient = client;
+  sspStats[client].selects++;
+}
+#endif
+
+/*****************************************************************************
+** Function name:		SSPGetStats
+**
+** Descriptions:		Get the statistics of a client
+**
+** parameters:			client number, SSP_CLIENT_xxx, and the structure
+**						to fill in
+** Returned value:		None
+** 
+*****************************************************************************/
+void SSPGetStats( uint32_t client, SSPStats *stats )
+{
+#if SSP_STATS
+  if ( client < SSP_CLIENTS )
+  {
+	*stats = sspStats[client];
+	return;
+  }
+#endif
+  memset( stats, 0, sizeof(SSPStats) );
+}
+
+/*****************************************************************************
+** Function name:		SSPResetStats
+**
+** Descriptions:		Clear the statistics of all clients
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+void SSPResetStats( void )
+{
+#if SSP_STATS
+  memset( sspStats, 0, sizeof(sspStats) );
+#endif
+}
+
+/*****************************************************************************
+** Function name:		SSPSetProfileHook
+**
+** Descriptions:		Install a function called after every transfer
+**						with the client, the byte count and the core
+**						cycles taken. The DWT cycle counter must be
+**						enabled for the cycle counts.
+**
+** parameters:			hook, NULL to remove it
+** Returned value:		None
+** 
+*****************************************************************************/
+void SSPSetProfileHook( SSPProfileHook hook )
+{
+#if SSP_STATS
+  sspHook = hook;
+#endif
+}
+
+/*****************************************************************************
+** Function name:		SSPDumpStats
+**
+** Descriptions:		Print the statistics of all clients on the UART
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+void SSPDumpStats( void )
+{
+  static const char *names[SSP_CLIENTS] = { "other", "oled", "led7", "flash" };
+  char line[80];
+  SSPStats stats;
+  uint32_t i;
+
+  for ( i = 0; i < SSP_CLIENTS; i++ )
+  {
+	SSPGetStats( i, &stats );
+	sprintf( line, "SSP %-5s %6u CS %6u xfers %7u bytes %9u cycles\r\n",
+			 names[i], stats.selects, stats.transfers, stats.bytes,
+			 stats.cycles );
+	UARTSendString( (uint8_t *)line );
+  }
+}
+
 /******************************************************************************
 **                            End Of File
 ******************************************************************************/
@@ -14,85 +14,154 @@
 // CodeRed - change for CMSIS 1.3
 #define SystemFrequency SystemCoreClock
 
-/* IRQ Handler only included as an example, not used */
-#if 0
+#if TX_INTERRUPT
+#include "cmsis_os.h"
+#endif
+
+#if TX_INTERRUPT
 
 volatile uint32_t UARTStatus;
 volatile uint8_t  UARTTxEmpty = 1;
-volatile uint8_t  UARTBuffer[BUFSIZE];
-volatile uint32_t UARTCount = 0;
+
+#define TX_MASK (UART_TX_BUFSIZE - 1)
+#define RX_MASK (UART_RX_BUFSIZE - 1)
+
+/*
+ * Single producer / single consumer rings. The ISR only moves rxHead
+ * and txTail, the thread side only moves rxTail and txHead.
+ */
+static volatile uint8_t  txBuf[UART_TX_BUFSIZE];
+static volatile uint8_t  rxBuf[UART_RX_BUFSIZE];
+static volatile uint32_t txHead = 0;
+static volatile uint32_t txTail = 0;
+static volatile uint32_t rxHead = 0;
+static volatile uint32_t rxTail = 0;
+
+static volatile uint32_t rxOverflow = 0;
+static volatile uint32_t txDropped = 0;
+static volatile uint8_t  rxWaiting = 0;
+static volatile uint8_t  txWaiting = 0;
+static uint32_t txBlocking = 1;
+
+osSemaphoreDef(uart_rx_sem);
+osSemaphoreDef(uart_tx_sem);
+static osSemaphoreId rxSem = NULL;
+static osSemaphoreId txSem = NULL;
+
+/* Move up to one FIFO worth of bytes from the TX ring to THR. */
+static void uartTxFill(void)
+{
+    uint32_t n = UART_FIFO_SIZE;
+
+    while (n != 0 && txTail != txHead)
+    {
+        LPC_UART->THR = txBuf[txTail];
+        txTail = (txTail + 1) & TX_MASK;
+        n--;
+    }
+}
+
+/* Drain the RX FIFO into the ring, counting bytes that do not fit. */
+static void uartRxDrain(void)
+{
+    uint32_t next;
+    uint8_t c;
+
+    while (LPC_UART->LSR & LSR_RDR)
+    {
+        c = LPC_UART->RBR;
+        next = (rxHead + 1) & RX_MASK;
+        if (next == rxTail)
+        {
+            rxOverflow++;
+            continue;
+        }
+        rxBuf[rxHead] = c;
+        rxHead = next;
+    }
+}
+
+/* Block the calling thread, or spin when no kernel is running. */
+static void uartWait(osSemaphoreId sem, volatile uint8_t *waiting, uint32_t millisec)
+{
+    if (osKernelRunning() && sem != NULL)
+    {
+        osSemaphoreWait(sem, millisec);
+    }
+    *waiting = 0;
+}
 
 /*****************************************************************************
  ** Function name:		UART_IRQHandler
  **
- ** Descriptions:		UART interrupt handler
+ ** Descriptions:		UART interrupt handler. Services the RX and
+ **				TX rings through the 16 byte hardware FIFOs
  **
  ** parameters:			None
  ** Returned value:		None
  **
  *****************************************************************************/
-
 void UART_IRQHandler(void)
 {
     uint8_t IIRValue, LSRValue;
     uint8_t Dummy = Dummy;
 
-    IIRValue = LPC_UART->IIR;
-
-    IIRValue >>= 1;			/* skip pending bit in IIR */
-    IIRValue &= 0x07;			/* check bit 1~3, interrupt identification */
-    if (IIRValue == IIR_RLS)		/* Receive Line Status */
+    while (((IIRValue = LPC_UART->IIR) & 0x01) == 0)
     {
-        LSRValue = LPC_UART->LSR;
-        /* Receive Line Status */
-        if (LSRValue & (LSR_OE | LSR_PE | LSR_FE | LSR_RXFE | LSR_BI))
+        IIRValue >>= 1;			/* skip pending bit in IIR */
+        IIRValue &= 0x07;			/* check bit 1~3, interrupt identification */
+
+        if (IIRValue == IIR_RLS)		/* Receive Line Status */
         {
-            /* There are errors or break interrupt */
             /* Read LSR will clear the interrupt */
+            LSRValue = LPC_UART->LSR;
             UARTStatus = LSRValue;
-            Dummy = LPC_UART->RBR;	/* Dummy read on RX to clear
-								interrupt, then bail out */
-            return;
-        }
-        if (LSRValue & LSR_RDR)	/* Receive Data Ready */
-        {
-            /* If no error on RLS, normal ready, save into the data buffer. */
-            /* Note: read RBR will clear the interrupt */
-            UARTBuffer[UARTCount++] = LPC_UART->RBR;
-            if (UARTCount == BUFSIZE)
+            if (LSRValue & LSR_OE)
+            {
+                rxOverflow++;		/* hardware FIFO overrun */
+            }
+            if (LSRValue & (LSR_PE | LSR_FE | LSR_RXFE | LSR_BI))
             {
-                UARTCount = 0;		/* buffer overflow */
+                Dummy = LPC_UART->RBR;	/* discard the bad character */
+            }
+            else
+            {
+                uartRxDrain();
             }
         }
-    }
-    else if (IIRValue == IIR_RDA)	/* Receive Data Available */
-    {
-        /* Receive Data Available */
-        UARTBuffer[UARTCount++] = LPC_UART->RBR;
-        if (UARTCount == BUFSIZE)
+        else if (IIRValue == IIR_RDA || IIRValue == IIR_CTI)
         {
-            UARTCount = 0;		/* buffer overflow */
+            /* Receive Data Available or Character Time-out */
+            uartRxDrain();
         }
-    }
-    else if (IIRValue == IIR_CTI)	/* Character timeout indicator */
-    {
-        /* Character Time-out indicator */
-        UARTStatus |= 0x100;		/* Bit 9 as the CTI error */
-    }
-    else if (IIRValue == IIR_THRE)	/* THRE, transmit holding register empty */
-    {
-        /* THRE interrupt */
-        LSRValue = LPC_UART->LSR;		/* Check status in the LSR to see if
-								valid data in U0THR or not */
-        if (LSRValue & LSR_THRE)
+        else if (IIRValue == IIR_THRE)	/* THRE, transmit holding register empty */
         {
-            UARTTxEmpty = 1;
+            /* reading IIR has cleared the THRE interrupt */
+            if (txTail == txHead)
+            {
+                UARTTxEmpty = 1;
+            }
+            else
+            {
+                uartTxFill();
+            }
+            if (txWaiting)
+            {
+                txWaiting = 0;
+                osSemaphoreRelease(txSem);
+            }
         }
         else
         {
-            UARTTxEmpty = 0;
+            break;
         }
     }
+
+    if (rxWaiting && rxHead != rxTail)
+    {
+        rxWaiting = 0;
+        osSemaphoreRelease(rxSem);
+    }
     return;
 }
 
@@ -144,15 +213,22 @@ void UARTInit(uint32_t baudrate)
     }
 
     /* Enable the UART Interrupt */
-#if 0
-    NVIC_EnableIRQ(UART_IRQn);
-
 #if TX_INTERRUPT
-    LPC_UART->IER = IER_RBR | IER_THRE | IER_RLS;	/* Enable UART interrupt */
-#else
-    LPC_UART->IER = IER_RBR | IER_RLS;	/* Enable UART interrupt */
-#endif
+    txHead = txTail = 0;
+    rxHead = rxTail = 0;
+    UARTTxEmpty = 1;
+    rxOverflow = 0;
+    txDropped = 0;
 
+    if (rxSem == NULL)
+    {
+        rxSem = osSemaphoreCreate(osSemaphore(uart_rx_sem), 0);
+        txSem = osSemaphoreCreate(osSemaphore(uart_tx_sem), 0);
+    }
+
+    LPC_UART->FCR = 0x81;		/* RX trigger at 8 bytes, FIFOs enabled */
+    LPC_UART->IER = IER_RBR | IER_THRE | IER_RLS;	/* Enable UART interrupt */
+    NVIC_EnableIRQ(UART_IRQn);
 #endif
 
     return;
@@ -175,6 +251,9 @@ void UARTSend(uint8_t *buffer, uint32_t length)
         return;
     }
 
+#if TX_INTERRUPT
+    UARTWrite(buffer, length, txBlocking);
+#else
     while ( length != 0 )
     {
         /* THRE status, contain valid data */
@@ -184,6 +263,7 @@ void UARTSend(uint8_t *buffer, uint32_t length)
         buffer++;
         length--;
     }
+#endif
     return;
 }
 
@@ -203,6 +283,17 @@ void UARTSendString(uint8_t *string)
         return;
     }
 
+#if TX_INTERRUPT
+    {
+        uint32_t length = 0;
+
+        while (string[length] != '\0')
+        {
+            length++;
+        }
+        UARTWrite(string, length, txBlocking);
+    }
+#else
     while ( *string != '\0' )
     {
         /* THRE status, contain valid data */
@@ -211,10 +302,138 @@ void UARTSendString(uint8_t *string)
 
         string++;
     }
+#endif
 
     return;
 }
 
+#if TX_INTERRUPT
+
+/*****************************************************************************
+ ** Function name:		UARTWrite
+ **
+ ** Descriptions:		Queue a block of data on the TX ring. Returns as
+ **				soon as the data is queued. When the ring is full
+ **				the call either waits for room (blocking) or drops
+ **				the remainder. Callers in interrupt context never
+ **				wait.
+ **
+ ** parameters:		buffer pointer, data length, blocking
+ ** Returned value:	Number of queued bytes
+ **
+ *****************************************************************************/
+uint32_t UARTWrite(uint8_t *buffer, uint32_t length, uint32_t blocking)
+{
+    uint32_t queued = 0;
+    uint32_t primask;
+    uint32_t next;
+
+    if (!buffer) {
+        /* error */
+        return 0;
+    }
+
+    if (__get_IPSR() != 0)
+    {
+        blocking = 0;
+    }
+
+    while (queued < length)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+
+        while (queued < length)
+        {
+            next = (txHead + 1) & TX_MASK;
+            if (next == txTail)
+            {
+                break;
+            }
+            txBuf[txHead] = buffer[queued++];
+            txHead = next;
+        }
+
+        if (UARTTxEmpty && txTail != txHead)
+        {
+            /* transmitter idle, prime the FIFO; THRE takes over from here */
+            UARTTxEmpty = 0;
+            uartTxFill();
+        }
+
+        if (queued < length && blocking)
+        {
+            txWaiting = osKernelRunning() ? 1 : 0;
+        }
+
+        __set_PRIMASK(primask);
+
+        if (queued < length)
+        {
+            if (!blocking)
+            {
+                txDropped += length - queued;
+                break;
+            }
+            uartWait(txSem, &txWaiting, osWaitForever);
+        }
+    }
+
+    return queued;
+}
+
+/*****************************************************************************
+ ** Function name:		UARTSetTxBlocking
+ **
+ ** Descriptions:		Select what UARTSend/UARTSendString do when the
+ **				TX ring is full: 1 waits for room, 0 drops data
+ **
+ ** parameters:		blocking
+ ** Returned value:	None
+ **
+ *****************************************************************************/
+void UARTSetTxBlocking(uint32_t blocking)
+{
+    txBlocking = blocking;
+}
+
+/*****************************************************************************
+ ** Function name:		UARTFlush
+ **
+ ** Descriptions:		Wait until the TX ring and the transmitter
+ **				are empty
+ **
+ ** parameters:		None
+ ** Returned value:	None
+ **
+ *****************************************************************************/
+void UARTFlush(void)
+{
+    while (txTail != txHead || !(LPC_UART->LSR & LSR_TEMT))
+    {
+        if (osKernelRunning() && __get_IPSR() == 0)
+        {
+            osDelay(1);
+        }
+    }
+}
+
+/*****************************************************************************
+ ** Function name:		UARTGetTxDropped
+ **
+ ** Descriptions:		Number of bytes dropped by non-blocking writes
+ **
+ ** parameters:		None
+ ** Returned value:	Dropped byte count
+ **
+ *****************************************************************************/
+uint32_t UARTGetTxDropped(void)
+{
+    return txDropped;
+}
+
+#endif
+
 /*****************************************************************************
  ** Function name:		UARTReceive
  **
@@ -227,6 +446,9 @@ void UARTSendString(uint8_t *string)
  *****************************************************************************/
 uint32_t UARTReceive(uint8_t *buffer, uint32_t length, uint32_t blocking)
 {
+#if TX_INTERRUPT
+    return UARTReceiveTimeout(buffer, length, blocking ? osWaitForever : 0);
+#else
     uint32_t recvd = 0;
     uint32_t toRecv = length;
 
@@ -260,8 +482,131 @@ uint32_t UARTReceive(uint8_t *buffer, uint32_t length, uint32_t blocking)
     }
 
     return recvd;
+#endif
 }
 
+#if TX_INTERRUPT
+
+/*****************************************************************************
+ ** Function name:		UARTReceiveTimeout
+ **
+ ** Descriptions:		Receive up to length bytes from the RX ring.
+ **				While the ring is empty the calling thread
+ **				sleeps on a semaphore for at most millisec
+ **				(osWaitForever waits indefinitely, 0 only takes
+ **				what is already buffered). Before the kernel
+ **				runs a non-zero timeout polls until length
+ **				bytes have arrived.
+ **
+ ** parameters:		buffer pointer, data length, timeout in ms
+ ** Returned value:	Number of received bytes
+ **
+ *****************************************************************************/
+uint32_t UARTReceiveTimeout(uint8_t *buffer, uint32_t length, uint32_t millisec)
+{
+    uint32_t recvd = 0;
+    uint32_t primask;
+    uint32_t start = 0;
+    uint32_t elapsed;
+    uint32_t wait = millisec;
+    uint32_t empty;
+
+    if (!buffer) {
+        /* error */
+        return 0;
+    }
+
+    if (__get_IPSR() != 0)
+    {
+        millisec = 0;
+    }
+    if (osKernelRunning())
+    {
+        start = osKernelSysTick();
+    }
+
+    while (recvd < length)
+    {
+        while (recvd < length && rxTail != rxHead)
+        {
+            buffer[recvd++] = rxBuf[rxTail];
+            rxTail = (rxTail + 1) & RX_MASK;
+        }
+
+        if (recvd == length || millisec == 0)
+        {
+            break;
+        }
+
+        if (!osKernelRunning())
+        {
+            continue;		/* no kernel: poll the ring */
+        }
+
+        if (millisec != osWaitForever)
+        {
+            elapsed = (osKernelSysTick() - start) / (osKernelSysTickFrequency / 1000);
+            if (elapsed >= millisec)
+            {
+                break;
+            }
+            wait = millisec - elapsed;
+        }
+
+        primask = __get_PRIMASK();
+        __disable_irq();
+        empty = (rxTail == rxHead);
+        if (empty)
+        {
+            rxWaiting = 1;
+        }
+        __set_PRIMASK(primask);
+
+        if (empty)
+        {
+            uartWait(rxSem, &rxWaiting, wait);
+        }
+    }
+
+    return recvd;
+}
+
+/*****************************************************************************
+ ** Function name:		UARTGetRxOverflow
+ **
+ ** Descriptions:		Number of received bytes lost because the RX
+ **				ring or the hardware FIFO was full
+ **
+ ** parameters:		None
+ ** Returned value:	Overflow count
+ **
+ *****************************************************************************/
+uint32_t UARTGetRxOverflow(void)
+{
+    return rxOverflow;
+}
+
+#if UART_RETARGET_STDOUT
+#include <stddef.h>
+
+/* IAR DLib low level write, makes printf go through the TX ring */
+size_t __write(int handle, const unsigned char *buffer, size_t size)
+{
+    if (buffer == 0)
+    {
+        return 0;		/* flush request, nothing is cached */
+    }
+    if (handle != 1 && handle != 2)
+    {
+        return (size_t)-1;
+    }
+    return UARTWrite((uint8_t *)buffer, size, txBlocking);
+}
+#endif
+
+#endif
+
+
 /******************************************************************************
  **                            End Of File
  ******************************************************************************/
@@ -0,0 +1,296 @@
+/*****************************************************************************
+ *   ustimer.c:  Microsecond timer service on the 32-bit timer 1
+ *
+ *   CT32B1 runs free with a 1us tick. Active timers are kept in a list
+ *   sorted by deadline and MR0 is always programmed with the earliest
+ *   one, so any number of one-shot and periodic deadlines share the
+ *   timer and nothing spins while waiting.
+ *
+ *   The service owns TIMER32_1_IRQHandler, so timer32.c must not be built
+ *   with TIMER32_GENERIC_INTS, and delay32Ms/delay32Us/init_timer32 must
+ *   not be used on timer 1.
+ *
+ *   History
+ *   2016.10.19  ver 1.00    First Release
+ *
+******************************************************************************/
+#include "mcu_regs.h"
+#include "cmsis_os.h"
+#include "ustimer.h"
+
+/* deadlines closer than this are treated as already expired */
+#define USTIMER_MIN_US	2
+
+static USTimer *USTimerList = NULL;
+static uint8_t USTimerStarted = 0;
+
+/* a is before b, valid across the 32-bit wrap (71 minutes) */
+#define BEFORE(a, b)	((int32_t)((a) - (b)) < 0)
+
+/* Insert in deadline order. Interrupts must be disabled. */
+static void USTimerInsert( USTimer *timer )
+{
+  USTimer **link = &USTimerList;
+
+  while ( *link != NULL && !BEFORE( timer->deadline, (*link)->deadline ) )
+  {
+	link = &(*link)->next;
+  }
+  timer->next = *link;
+  *link = timer;
+  timer->active = 1;
+}
+
+/* Unlink if present. Interrupts must be disabled. */
+static void USTimerRemove( USTimer *timer )
+{
+  USTimer **link = &USTimerList;
+
+  while ( *link != NULL )
+  {
+	if ( *link == timer )
+	{
+	  *link = timer->next;
+	  break;
+	}
+	link = &(*link)->next;
+  }
+  timer->next = NULL;
+  timer->active = 0;
+}
+
+/* Program MR0 for the head of the list. Interrupts must be disabled. */
+static void USTimerArm( void )
+{
+  if ( USTimerList == NULL )
+  {
+	LPC_TMR32B1->MCR = 0;		/* nothing pending, no match interrupt */
+	return;
+  }
+  LPC_TMR32B1->MR0 = USTimerList->deadline;
+  LPC_TMR32B1->MCR = 0x01;		/* interrupt on MR0, keep running */
+  if ( BEFORE( USTimerList->deadline, LPC_TMR32B1->TC + USTIMER_MIN_US ) )
+  {
+	/* the match may already have been passed */
+	NVIC_SetPendingIRQ( TIMER_32_1_IRQn );
+  }
+}
+
+/* osDelayUs wake up */
+static void USTimerWake( void *arg )
+{
+  osSignalSet( (osThreadId)arg, USTIMER_SIGNAL );
+}
+
+/******************************************************************************
+** Function name:		TIMER32_1_IRQHandler
+**
+** Descriptions:		Run the callbacks of all expired timers, reload
+**						the periodic ones and program the next match.
+**						The list is only touched with interrupts
+**						disabled, since higher priority ISRs may start
+**						or stop timers; the callbacks run with them
+**						enabled.
+**
+** parameters:			None
+** Returned value:		None
+** 
+******************************************************************************/
+void TIMER32_1_IRQHandler(void)
+{
+  USTimer *timer;
+  USTimerCallback callback;
+  void *arg;
+  uint32_t now;
+  uint32_t primask;
+
+  LPC_TMR32B1->IR = 0x01;		/* clear MR0 interrupt flag */
+
+  primask = __get_PRIMASK();
+  while ( 1 )
+  {
+	__disable_irq();
+
+	now = LPC_TMR32B1->TC + USTIMER_MIN_US;
+	timer = USTimerList;
+	if ( timer == NULL || BEFORE( now, timer->deadline ) )
+	{
+	  USTimerArm();
+	  __set_PRIMASK( primask );
+	  break;
+	}
+
+	USTimerList = timer->next;
+	timer->next = NULL;
+	timer->active = 0;
+
+	if ( timer->period )
+	{
+	  /* the next deadline after now, periods missed while the handler
+		 ran late are dropped rather than run back to back */
+	  timer->deadline += ( ( now - timer->deadline ) / timer->period + 1 )
+						 * timer->period;
+	  USTimerInsert( timer );
+	}
+	callback = timer->callback;
+	arg = timer->arg;
+
+	__set_PRIMASK( primask );
+
+	if ( callback )
+	{
+	  callback( arg );
+	}
+  }
+  return;
+}
+
+/*****************************************************************************
+** Function name:		USTimerInit
+**
+** Descriptions:		Start CT32B1 as a free running 1us counter
+**
+** parameters:			None
+** Returned value:		None
+** 
+*****************************************************************************/
+void USTimerInit( void )
+{
+  LPC_SYSCON->SYSAHBCLKCTRL |= (1<<10);
+
+  LPC_TMR32B1->TCR = 0x02;		/* reset timer */
+  LPC_TMR32B1->PR  = (SystemCoreClock/LPC_SYSCON->SYSAHBCLKDIV) / 1000000 - 1;
+  LPC_TMR32B1->MCR = 0;
+  LPC_TMR32B1->IR  = 0xff;		/* reset all interrrupts */
+  LPC_TMR32B1->TCR = 0x01;		/* start timer */
+
+  USTimerList = NULL;
+  USTimerStarted = 1;
+  NVIC_EnableIRQ( TIMER_32_1_IRQn );
+  return;
+}
+
+/*****************************************************************************
+** Function name:		USTimerRunning
+**
+** Descriptions:		Tell whether USTimerInit was called. osDelayUs
+**				and USTimerStart never expire before that, so
+**				drivers check this and fall back to osDelay.
+**
+** parameters:			None
+** Returned value:		TRUE if the service is running
+** 
+*****************************************************************************/
+uint32_t USTimerRunning( void )
+{
+  return ( USTimerStarted );
+}
+
+/*****************************************************************************
+** Function name:		USTimerNow
+**
+** Descriptions:		Current time of the service
+**
+** parameters:			None
+** Returned value:		Time in us, wraps after 2^32 us
+** 
+*****************************************************************************/
+uint32_t USTimerNow( void )
+{
+  return LPC_TMR32B1->TC;
+}
+
+/*****************************************************************************
+** Function name:		USTimerStart
+**
+** Descriptions:		(Re)start a timer. The callback runs from the
+**						timer interrupt delayInUs from now and then every
+**						periodInUs if that is not 0. Periodic deadlines
+**						are advanced from the previous deadline, so they
+**						do not drift; periods that were missed entirely
+**						are skipped. Callable from threads and ISRs.
+**
+** parameters:			timer node, delay in us, period in us, callback,
+**						callback argument
+** Returned value:		None
+** 
+*****************************************************************************/
+void USTimerStart( USTimer *timer, uint32_t delayInUs, uint32_t periodInUs,
+                   USTimerCallback callback, void *arg )
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if ( timer->active )
+  {
+	USTimerRemove( timer );
+  }
+  timer->deadline = LPC_TMR32B1->TC + delayInUs;
+  timer->period = periodInUs;
+  timer->callback = callback;
+  timer->arg = arg;
+  USTimerInsert( timer );
+  if ( USTimerList == timer )
+  {
+	USTimerArm();
+  }
+
+  __set_PRIMASK( primask );
+  return;
+}
+
+/*****************************************************************************
+** Function name:		USTimerStop
+**
+** Descriptions:		Cancel a timer. Callable from threads and ISRs,
+**						including from the timer's own callback.
+**
+** parameters:			timer node
+** Returned value:		None
+** 
+*****************************************************************************/
+void USTimerStop( USTimer *timer )
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if ( timer->active )
+  {
+	USTimerRemove( timer );
+	USTimerArm();
+  }
+
+  __set_PRIMASK( primask );
+  return;
+}
+
+/*****************************************************************************
+** Function name:		osDelayUs
+**
+** Descriptions:		Suspend the calling thread for delayInUs. The
+**						thread sleeps on USTIMER_SIGNAL, other threads
+**						run meanwhile.
+**
+** parameters:			delay in us
+** Returned value:		None
+** 
+*****************************************************************************/
+void osDelayUs( uint32_t delayInUs )
+{
+  USTimer timer;
+
+  timer.active = 0;
+  timer.next = NULL;
+  osSignalClear( osThreadGetId(), USTIMER_SIGNAL );
+  USTimerStart( &timer, delayInUs, 0, USTimerWake, osThreadGetId() );
+  osSignalWait( USTIMER_SIGNAL, osWaitForever );
+  return;
+}
+
+/******************************************************************************
+**                            End Of File
+******************************************************************************/
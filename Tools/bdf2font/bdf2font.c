@@ -0,0 +1,263 @@
+/*****************************************************************************
+ *   bdf2font.c:  Convert a BDF bitmap font into the packed font_t format
+ *                used by oled_putText
+ *
+ *   Build and run from the repository root:
+ *
+ *   gcc -std=gnu99 -o bdf2font Tools/bdf2font/bdf2font.c
+ *
+ *   ./bdf2font Tools/bdf2font/digits16.bdf digits16
+ *       > Lib_EaBaseBoard/src/font_digits16.c
+ *
+ *   An optional character range can be given after the name, e.g.
+ *   "./bdf2font font.bdf small 0x20 0x7e"; by default every encoding
+ *   between the lowest and the highest glyph of the font is included.
+ *
+ *   Each glyph becomes DWIDTH columns of (FONT_ASCENT + FONT_DESCENT)
+ *   pixels. The columns are packed top pixel first, LSB first, without
+ *   padding between them, and every glyph starts on a byte boundary.
+ *   Codes inside the range with no glyph get a width of 0.
+ *
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_HEIGHT  24      /* FONT_MAX_HEIGHT in font.h */
+#define MAX_WIDTH   32
+#define MAX_CODES   256
+
+typedef struct
+{
+    int present;
+    int width;
+    unsigned char pixel[MAX_HEIGHT][MAX_WIDTH];
+} glyph_t;
+
+static glyph_t glyphs[MAX_CODES];
+static int ascent = -1;
+static int descent = -1;
+static int bbxH = 0;
+static int bbxY = 0;
+
+
+static void fail(const char *msg, int line)
+{
+    fprintf(stderr, "bdf2font: %s (line %d)\n", msg, line);
+    exit(1);
+}
+
+static int hexValue(int c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = toupper(c);
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static void readFont(FILE *in)
+{
+    char line[256];
+    int lineNo = 0;
+    int code = -1;
+    int dwidth = 0;
+    int w = 0, h = 0, xoff = 0, yoff = 0;
+    int row = -1;       /* bitmap row being read, -1 outside BITMAP */
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        lineNo++;
+
+        if (row >= 0) {
+            glyph_t *g;
+            int top;
+            int x;
+
+            if (strncmp(line, "ENDCHAR", 7) == 0) {
+                row = -1;
+                continue;
+            }
+            if (code < 0 || code >= MAX_CODES) {
+                row++;
+                continue;
+            }
+            if (ascent < 0) {
+                fail("FONT_ASCENT must come before the glyphs", lineNo);
+            }
+
+            g = &glyphs[code];
+            top = ascent - (yoff + h);
+            for (x = 0; x < w; x++) {
+                int nibble = hexValue(line[x / 4]);
+                int cx = xoff + x;
+                int cy = top + row;
+
+                if (nibble < 0) {
+                    fail("bad bitmap row", lineNo);
+                }
+                if ((nibble & (8 >> (x % 4))) == 0) {
+                    continue;
+                }
+                if (cx < 0 || cx >= MAX_WIDTH || cy < 0
+                        || cy >= ascent + descent) {
+                    fail("glyph pixel outside the font cell", lineNo);
+                }
+                g->pixel[cy][cx] = 1;
+                if (cx >= g->width) {
+                    g->width = cx + 1;
+                }
+            }
+            row++;
+            continue;
+        }
+
+        if (sscanf(line, "FONT_ASCENT %d", &ascent) == 1
+                || sscanf(line, "FONT_DESCENT %d", &descent) == 1) {
+            continue;
+        }
+        if (sscanf(line, "FONTBOUNDINGBOX %*d %d %*d %d", &bbxH, &bbxY) == 2) {
+            continue;
+        }
+        if (strncmp(line, "STARTCHAR", 9) == 0) {
+            code = -1;
+            dwidth = 0;
+            w = h = xoff = yoff = 0;
+        }
+        else if (sscanf(line, "ENCODING %d", &code) == 1) {
+            continue;
+        }
+        else if (sscanf(line, "DWIDTH %d", &dwidth) == 1) {
+            continue;
+        }
+        else if (sscanf(line, "BBX %d %d %d %d", &w, &h, &xoff, &yoff) == 4) {
+            continue;
+        }
+        else if (strncmp(line, "BITMAP", 6) == 0) {
+            if (ascent < 0 && bbxH > 0) {
+                /* no properties, use the font bounding box */
+                ascent = bbxH + bbxY;
+                descent = -bbxY;
+            }
+            if (ascent < 0 || descent < 0 || ascent + descent > MAX_HEIGHT) {
+                fail("font height missing or larger than 24", lineNo);
+            }
+            if (dwidth > MAX_WIDTH) {
+                fail("glyph wider than 32", lineNo);
+            }
+            if (code >= 0 && code < MAX_CODES) {
+                glyphs[code].present = 1;
+                glyphs[code].width = dwidth;
+            }
+            row = 0;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *name;
+    FILE *in;
+    int height;
+    int first = -1;
+    int last = -1;
+    int offset = 0;
+    int count = 0;
+    int c, x, y;
+
+    if (argc != 3 && argc != 5) {
+        fprintf(stderr, "usage: %s <font.bdf> <name> [first last]\n", argv[0]);
+        return 1;
+    }
+    name = argv[2];
+
+    in = fopen(argv[1], "r");
+    if (in == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    readFont(in);
+    fclose(in);
+    height = ascent + descent;
+
+    if (argc == 5) {
+        first = strtol(argv[3], NULL, 0);
+        last = strtol(argv[4], NULL, 0);
+    }
+    else {
+        for (c = 0; c < MAX_CODES; c++) {
+            if (glyphs[c].present) {
+                if (first < 0) {
+                    first = c;
+                }
+                last = c;
+            }
+        }
+    }
+    if (first < 0 || last < first || last >= MAX_CODES) {
+        fprintf(stderr, "bdf2font: no glyphs in the range\n");
+        return 1;
+    }
+
+    printf("/* Generated by bdf2font from %s - do not edit */\n", argv[1]);
+    printf("#include \"type.h\"\n#include \"font.h\"\n\n");
+
+    printf("static const uint8_t %s_width[] =\n{\n", name);
+    for (c = first; c <= last; c++) {
+        printf("%s%2d,%s", (c - first) % 16 == 0 ? "    " : " ",
+               glyphs[c].present ? glyphs[c].width : 0,
+               (c - first) % 16 == 15 || c == last ? "\n" : "");
+    }
+    printf("};\n\n");
+
+    printf("static const uint16_t %s_offset[] =\n{\n", name);
+    for (c = first; c <= last; c++) {
+        printf("%s%4d,%s", (c - first) % 12 == 0 ? "    " : " ", offset,
+               (c - first) % 12 == 11 || c == last ? "\n" : "");
+        if (glyphs[c].present) {
+            offset += (glyphs[c].width * height + 7) / 8;
+        }
+    }
+    printf("};\n\n");
+
+    printf("static const uint8_t %s_bits[] =\n{\n", name);
+    for (c = first; c <= last; c++) {
+        unsigned int acc = 0;
+        int nbits = 0;
+        int n = 0;
+
+        if (!glyphs[c].present || glyphs[c].width == 0) {
+            continue;
+        }
+        count++;
+        printf("    /* '%c' */\n   ", isprint(c) ? c : '?');
+        for (x = 0; x < glyphs[c].width; x++) {
+            for (y = 0; y < height; y++) {
+                acc |= glyphs[c].pixel[y][x] << nbits;
+                if (++nbits == 8) {
+                    printf(" 0x%02X,%s", acc, ++n % 12 == 0 ? "\n   " : "");
+                    acc = 0;
+                    nbits = 0;
+                }
+            }
+        }
+        if (nbits != 0) {
+            printf(" 0x%02X,", acc);
+        }
+        printf("\n");
+    }
+    printf("};\n\n");
+
+    printf("const font_t font_%s =\n{\n", name);
+    printf("    %d, 0x%02X, 0x%02X,\n", height, first, last);
+    printf("    %s_width, %s_offset, %s_bits\n};\n", name, name, name);
+
+    fprintf(stderr, "%s: %d glyphs, %d pixels high, %d bytes of glyph data, "
+            "%d bytes in total\n", name, count, height, offset,
+            offset + 3 * (last - first + 1) + 16);
+    return 0;
+}
@@ -0,0 +1,406 @@
+/*****************************************************************************
+ *   oled_emu.c:  Host emulator of the SSD1305 OLED controller
+ *
+ ******************************************************************************/
+
+/*
+ * The emulator replaces the SSP, GPIO and RTOS functions used by oled.c so
+ * the driver runs unmodified on the host. Bytes sent while CS (P0.2) is low
+ * are decoded as commands or display data depending on D/C (P2.7), into a
+ * 132x64 RAM with page addressing, like the controller does.
+ *
+ * Pixels are read back in driver coordinates: x is the RAM column minus
+ * X_OFFSET, y is the RAM row after the display start line is applied.
+ * Segment remap and COM scan direction are properties of the panel wiring
+ * and are not applied.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "gpio.h"
+#include "cmsis_os.h"
+#include "oled_emu.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+
+#define PIN_CS_PORT     0
+#define PIN_CS_MASK     (1 << 2)
+#define PIN_DC_PORT     2
+#define PIN_DC_MASK     (1 << 7)
+
+struct os_thread_cb
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int32_t signals;
+    os_pthread func;
+    void *arg;
+};
+
+struct os_semaphore_cb
+{
+    sem_t sem;
+};
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+static uint8_t ram[EMU_PAGES][EMU_COLUMNS];
+static uint8_t page = 0;
+static uint8_t column = 0;
+static uint8_t startLine = 0;
+static uint8_t argsLeft = 0;
+
+static uint8_t csLow = 0;
+static uint8_t dataMode = 0;
+
+static emu_stats_t stats;
+
+static __thread struct os_thread_cb *self = NULL;
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/* number of argument bytes following a command */
+static uint8_t commandArgs(uint8_t cmd)
+{
+    switch (cmd) {
+    case 0x81: case 0x82: case 0xa8: case 0xad: case 0xd3:
+    case 0xd5: case 0xd8: case 0xd9: case 0xda: case 0xdb:
+        return 1;
+    case 0xa3:
+        return 2;
+    case 0x26: case 0x27:
+        return 4;
+    case 0x29: case 0x2a:
+        return 5;
+    case 0x91:
+        return 4;
+    }
+    return 0;
+}
+
+static void command(uint8_t cmd)
+{
+    if (argsLeft) {
+        argsLeft--;
+        return;
+    }
+
+    if (cmd <= 0x0f) {
+        column = (column & 0xf0) | cmd;
+    }
+    else if (cmd <= 0x1f) {
+        column = (column & 0x0f) | ((cmd & 0x0f) << 4);
+    }
+    else if (cmd >= 0x40 && cmd <= 0x7f) {
+        startLine = cmd & 0x3f;
+    }
+    else if (cmd >= 0xb0 && cmd <= 0xb7) {
+        page = cmd & 0x07;
+    }
+    else {
+        argsLeft = commandArgs(cmd);
+    }
+}
+
+static void data(uint8_t byte)
+{
+    if (column < EMU_COLUMNS) {
+        ram[page][column] = byte;
+    }
+    /* page addressing: the column pointer wraps within the page */
+    column = (column + 1) % EMU_COLUMNS;
+}
+
+static void *threadMain(void *arg)
+{
+    struct os_thread_cb *t = arg;
+
+    self = t;
+    t->func(t->arg);
+
+    return NULL;
+}
+
+static struct os_thread_cb *newThread(void)
+{
+    struct os_thread_cb *t = calloc(1, sizeof(*t));
+
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->cond, NULL);
+
+    return t;
+}
+
+/******************************************************************************
+ * Driver interface: SSP, GPIO and RTOS
+ *****************************************************************************/
+
+void SSPSend( uint8_t *buf, uint32_t Length )
+{
+    uint32_t i;
+
+    if (!csLow) {
+        return;
+    }
+
+    for (i = 0; i < Length; i++) {
+        if (dataMode) {
+            stats.dataBytes++;
+            data(buf[i]);
+        }
+        else {
+            stats.cmdBytes++;
+            command(buf[i]);
+        }
+    }
+}
+
+void SSPLock( void )
+{
+}
+
+void SSPUnlock( void )
+{
+}
+
+void SSPSelect( uint32_t client )
+{
+    (void)client;
+}
+
+void I2CWrite(uint8_t addr, uint8_t* buf, uint32_t len)
+{
+    fprintf(stderr, "oled_emu: I2C mode is not emulated\n");
+    exit(1);
+}
+
+void EmuPinWrite( uint32_t port, uint32_t mask, uint32_t value )
+{
+    if (port == PIN_CS_PORT && (mask & PIN_CS_MASK)) {
+        if (!value && !csLow) {
+            stats.transfers++;
+        }
+        csLow = !value;
+    }
+    if (port == PIN_DC_PORT && (mask & PIN_DC_MASK)) {
+        dataMode = value;
+    }
+}
+
+void GPIOSetDir( uint32_t portNum, uint32_t bitPosi, uint32_t dir )
+{
+}
+
+void GPIOSetValue( uint32_t portNum, uint32_t bitPosi, uint32_t bitVal )
+{
+    EmuPinWrite(portNum, 1 << bitPosi, bitVal);
+}
+
+int32_t osKernelRunning (void)
+{
+    return 1;
+}
+
+osThreadId osThreadCreate (const osThreadDef_t *thread_def, void *argument)
+{
+    struct os_thread_cb *t = newThread();
+
+    t->func = thread_def->pthread;
+    t->arg = argument;
+    pthread_create(&t->thread, NULL, threadMain, t);
+
+    return t;
+}
+
+osThreadId osThreadGetId (void)
+{
+    if (self == NULL) {
+        self = newThread();
+    }
+    return self;
+}
+
+int32_t osSignalSet (osThreadId t, int32_t signals)
+{
+    int32_t old;
+
+    pthread_mutex_lock(&t->lock);
+    old = t->signals;
+    t->signals |= signals;
+    pthread_cond_signal(&t->cond);
+    pthread_mutex_unlock(&t->lock);
+
+    return old;
+}
+
+osEvent osSignalWait (int32_t signals, uint32_t millisec)
+{
+    struct os_thread_cb *t = osThreadGetId();
+    osEvent evt;
+
+    pthread_mutex_lock(&t->lock);
+    while ((t->signals & signals) != signals) {
+        pthread_cond_wait(&t->cond, &t->lock);
+    }
+    evt.status = osEventSignal;
+    evt.value.signals = t->signals;
+    t->signals &= ~signals;
+    pthread_mutex_unlock(&t->lock);
+
+    return evt;
+}
+
+osSemaphoreId osSemaphoreCreate (const osSemaphoreDef_t *semaphore_def, int32_t count)
+{
+    struct os_semaphore_cb *s = calloc(1, sizeof(*s));
+
+    sem_init(&s->sem, 0, count);
+
+    return s;
+}
+
+int32_t osSemaphoreWait (osSemaphoreId s, uint32_t millisec)
+{
+    sem_wait(&s->sem);
+    return 1;
+}
+
+osStatus osSemaphoreRelease (osSemaphoreId s)
+{
+    sem_post(&s->sem);
+    return osOK;
+}
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * Description:
+ *    Power-on state: RAM cleared, address and start line 0, no statistics
+ *
+ *****************************************************************************/
+void emu_reset (void)
+{
+    memset(ram, 0, sizeof(ram));
+    page = 0;
+    column = 0;
+    startLine = 0;
+    argsLeft = 0;
+    emu_clearStats();
+}
+
+void emu_getStats (emu_stats_t *s)
+{
+    *s = stats;
+}
+
+void emu_clearStats (void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Pixel as shown on the 96x64 panel
+ *
+ *****************************************************************************/
+uint8_t emu_getPixel (uint8_t x, uint8_t y)
+{
+    uint8_t row = (y + startLine) & 0x3f;
+
+    return (ram[row >> 3][x + EMU_X_OFFSET] >> (row & 7)) & 1;
+}
+
+uint8_t emu_getStartLine (void)
+{
+    return startLine;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Write the panel contents as a plain (P1) PBM, 1 is a lit pixel
+ *
+ * Returns:
+ *    0 if successful, -1 if the file could not be written
+ *
+ *****************************************************************************/
+int emu_writePbm (const char *path)
+{
+    FILE *f = fopen(path, "w");
+    int x, y;
+
+    if (f == NULL) {
+        return -1;
+    }
+
+    fprintf(f, "P1\n96 64\n");
+    for (y = 0; y < 64; y++) {
+        for (x = 0; x < 96; x++) {
+            fputc(emu_getPixel(x, y) ? '1' : '0', f);
+        }
+        fputc('\n', f);
+    }
+    fclose(f);
+
+    return 0;
+}
+
+/******************************************************************************
+ *
+ * Description:
+ *    Compare the panel contents with a PBM written by emu_writePbm
+ *
+ * Returns:
+ *    number of differing pixels, -1 if the file is missing or invalid
+ *
+ *****************************************************************************/
+int emu_comparePbm (const char *path)
+{
+    FILE *f = fopen(path, "r");
+    int x, y, c, w, h;
+    int diff = 0;
+
+    if (f == NULL) {
+        return -1;
+    }
+    if (fscanf(f, "P1 %d %d", &w, &h) != 2 || w != 96 || h != 64) {
+        fclose(f);
+        return -1;
+    }
+
+    for (y = 0; y < 64; y++) {
+        for (x = 0; x < 96; x++) {
+            do {
+                c = fgetc(f);
+            } while (c == ' ' || c == '\n' || c == '\r');
+            if (c != '0' && c != '1') {
+                fclose(f);
+                return -1;
+            }
+            if ((c == '1') != emu_getPixel(x, y)) {
+                diff++;
+            }
+        }
+    }
+    fclose(f);
+
+    return diff;
+}
@@ -0,0 +1,29 @@
+/*****************************************************************************
+ *   oled_emu.h:  Host emulator of the SSD1305 OLED controller
+ *
+******************************************************************************/
+#ifndef __OLED_EMU_H
+#define __OLED_EMU_H
+
+#include <stdint.h>
+
+#define EMU_COLUMNS     132     /* controller RAM, the panel shows 96 */
+#define EMU_PAGES       8
+#define EMU_X_OFFSET    18      /* first column wired to the panel */
+
+typedef struct
+{
+    uint32_t cmdBytes;      /* bytes sent with D/C low */
+    uint32_t dataBytes;     /* bytes sent with D/C high */
+    uint32_t transfers;     /* CS assertions */
+} emu_stats_t;
+
+void emu_reset (void);
+void emu_getStats (emu_stats_t *stats);
+void emu_clearStats (void);
+uint8_t emu_getPixel (uint8_t x, uint8_t y);
+uint8_t emu_getStartLine (void);
+int emu_writePbm (const char *path);
+int emu_comparePbm (const char *path);
+
+#endif /* end __OLED_EMU_H */
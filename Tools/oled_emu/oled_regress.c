@@ -0,0 +1,487 @@
+/*****************************************************************************
+ *   oled_regress.c:  Pixel-exact regression test of the OLED driver on the
+ *                    host, against golden PBM images
+ *
+ *   Build and run from the repository root:
+ *
+ *   gcc -std=gnu99 -pthread -o oled_regress
+ *       -ITools/oled_emu/shim -ITools/oled_emu
+ *       -ILib_MCU/inc -ILib_EaBaseBoard/inc
+ *       Tools/oled_emu/oled_regress.c Tools/oled_emu/oled_emu.c
+ *       Lib_EaBaseBoard/src/oled.c Lib_EaBaseBoard/src/font5x7.c
+ *       Lib_EaBaseBoard/src/font_digits16.c Lib_EaBaseBoard/src/chart.c
+ *
+ *   ./oled_regress Tools/oled_emu/golden            compare
+ *   ./oled_regress Tools/oled_emu/golden --update   write new golden images
+ *
+ *   Every scene is drawn in immediate, retained and double buffered mode
+ *   and must match the same golden image. The SPI bytes sent for each
+ *   frame are printed, so the cost of a driver change can be compared.
+ *
+ *   The golden images are snapshots of the driver, so two checks do not
+ *   depend on them: the "ref-" scenes draw the text, shapes and dashboard
+ *   scenes again with oled_putPixel only, as the original driver did, and
+ *   must match the same images; and oled_blit is compared with a per-pixel
+ *   model over BLIT_CASES random cases in each mode.
+ *
+******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "type.h"
+#include "oled.h"
+#include "font5x7.h"
+#include "chart.h"
+#include "oled_emu.h"
+
+#define BLIT_CASES  1000
+
+typedef struct
+{
+    const char *name;
+    void (*draw)(void);
+    const char *golden;     /* image of another scene to match, or NULL */
+} scene_t;
+
+static void sceneText(void)
+{
+    oled_clearScreen(OLED_COLOR_BLACK);
+    oled_putString(0, 0, (uint8_t *)"Hello OLED", OLED_COLOR_WHITE,
+                   OLED_COLOR_BLACK);
+    oled_putString(3, 13, (uint8_t *)"y=13 !#$%&", OLED_COLOR_WHITE,
+                   OLED_COLOR_BLACK);
+    oled_putString(10, 30, (uint8_t *)"inverse", OLED_COLOR_BLACK,
+                   OLED_COLOR_WHITE);
+    oled_putString(0, 55, (uint8_t *)"~{|}0123456789", OLED_COLOR_WHITE,
+                   OLED_COLOR_BLACK);
+}
+
+static void sceneShapes(void)
+{
+    oled_clearScreen(OLED_COLOR_BLACK);
+    oled_rect(0, 0, 95, 63, OLED_COLOR_WHITE);
+    oled_fillRect(5, 3, 30, 20, OLED_COLOR_WHITE);
+    oled_fillRect(10, 7, 20, 11, OLED_COLOR_BLACK);
+    oled_line(40, 5, 90, 30, OLED_COLOR_WHITE);
+    oled_line(90, 5, 80, 60, OLED_COLOR_WHITE);
+    oled_line(35, 60, 60, 40, OLED_COLOR_WHITE);
+    oled_circle(25, 42, 15, OLED_COLOR_WHITE);
+    oled_putPixel(94, 62, OLED_COLOR_WHITE);
+}
+
+static void sceneDashboard(void)
+{
+    oled_clearScreen(OLED_COLOR_WHITE);
+    oled_rect(0, 0, 95, 63, OLED_COLOR_BLACK);
+    oled_line(0, 12, 95, 12, OLED_COLOR_BLACK);
+    oled_putString(4, 3, (uint8_t *)"Dashboard", OLED_COLOR_BLACK,
+                   OLED_COLOR_WHITE);
+    oled_putString(4, 16, (uint8_t *)"Temp 231", OLED_COLOR_BLACK,
+                   OLED_COLOR_WHITE);
+    oled_putString(4, 26, (uint8_t *)"Lux  481", OLED_COLOR_BLACK,
+                   OLED_COLOR_WHITE);
+    oled_fillRect(4, 48, 60, 56, OLED_COLOR_BLACK);
+    oled_circle(80, 30, 8, OLED_COLOR_BLACK);
+}
+
+/* small change of the previous frame, shows the cost of an update */
+static void sceneUpdate(void)
+{
+    oled_putString(34, 26, (uint8_t *)"517", OLED_COLOR_BLACK,
+                   OLED_COLOR_WHITE);
+    oled_fillRect(60, 48, 70, 56, OLED_COLOR_BLACK);
+}
+
+/* packed font at page aligned and shifted positions, right aligned value */
+static void sceneReadout(void)
+{
+    uint8_t *value = (uint8_t *)"-12.5%";
+
+    oled_clearScreen(OLED_COLOR_BLACK);
+    oled_putText(0, 0, (uint8_t *)"0123456789", &font_digits16,
+                 OLED_COLOR_WHITE, OLED_COLOR_BLACK);
+    oled_putText(2, 21, (uint8_t *)"12:34 +5", &font_digits16,
+                 OLED_COLOR_WHITE, OLED_COLOR_BLACK);
+    oled_fillRect(0, 42, 95, 63, OLED_COLOR_WHITE);
+    oled_putText(95 - oled_textWidth(value, &font_digits16), 45, value,
+                 &font_digits16, OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+}
+
+/* 16x16 warning sign, two pages of column bytes */
+static const uint8_t icon[] = {
+    0x00, 0x00, 0x00, 0x80, 0xE0, 0x38, 0x0E, 0xE3,
+    0xE3, 0x0E, 0x38, 0xE0, 0x80, 0x00, 0x00, 0x00,
+    0xE0, 0xF8, 0xCE, 0xC3, 0xC0, 0xC0, 0xC0, 0xDB,
+    0xDB, 0xC0, 0xC0, 0xC0, 0xC3, 0xCE, 0xF8, 0xE0,
+};
+
+/* every raster operation, page aligned, shifted and clipped */
+static void sceneIcons(void)
+{
+    oled_clearScreen(OLED_COLOR_BLACK);
+    oled_fillRect(48, 0, 95, 31, OLED_COLOR_WHITE);
+    oled_blit(0, 0, 16, 16, icon, OLED_ROP_COPY);
+    oled_blit(18, 5, 16, 16, icon, OLED_ROP_COPY);
+    oled_blit(30, 12, 16, 16, icon, OLED_ROP_OR);
+    oled_blit(52, 3, 16, 16, icon, OLED_ROP_AND);
+    oled_blit(74, 8, 16, 16, icon, OLED_ROP_XOR);
+    oled_blit(-6, 40, 16, 16, icon, OLED_ROP_COPY);
+    oled_blit(40, 24, 16, 16, icon, OLED_ROP_XOR);
+    oled_blit(86, 53, 16, 16, icon, OLED_ROP_COPY);
+    oled_blit(60, -9, 16, 16, icon, OLED_ROP_XOR);
+}
+
+/* a full screen clear alone */
+static void sceneClear(void)
+{
+    oled_clearScreen(OLED_COLOR_WHITE);
+}
+
+/* strip chart scrolled past one screen height, leaves the start line
+   at 100 % 64 so it must come last */
+static void sceneChart(void)
+{
+    int32_t i, v;
+
+    chart_init(0, 100, OLED_COLOR_WHITE, OLED_COLOR_BLACK);
+    for (i = 0; i < 100; i++) {
+        v = (i * 7) % 200;
+        chart_add((v > 100 ? 200 - v : v) + (i % 5) * 3);
+    }
+}
+
+/*
+ * Reference primitives built on oled_putPixel alone, the way the original
+ * driver drew lines, rectangles and characters. oled_circle is still
+ * drawn pixel by pixel and is used as is.
+ */
+static void refHLine(uint8_t x0, uint8_t y0, uint8_t x1, oled_color_t color)
+{
+    uint8_t bak;
+
+    if (x0 > x1) {
+        bak = x1;
+        x1 = x0;
+        x0 = bak;
+    }
+    while (x1 >= x0) {
+        oled_putPixel(x0, y0, color);
+        x0++;
+    }
+}
+
+static void refVLine(uint8_t x0, uint8_t y0, uint8_t y1, oled_color_t color)
+{
+    uint8_t bak;
+
+    if (y0 > y1) {
+        bak = y1;
+        y1 = y0;
+        y0 = bak;
+    }
+    while (y1 >= y0) {
+        oled_putPixel(x0, y0, color);
+        y0++;
+    }
+}
+
+static void refLine(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
+                    oled_color_t color)
+{
+    int16_t dx = x1 - x0;
+    int16_t dy = y1 - y0;
+    int8_t dxSym = (dx > 0) ? 1 : -1;
+    int8_t dySym = (dy > 0) ? 1 : -1;
+    int16_t di;
+
+    if (dx == 0) {
+        refVLine(x0, y0, y1, color);
+        return;
+    }
+    if (dy == 0) {
+        refHLine(x0, y0, x1, color);
+        return;
+    }
+
+    dx *= dxSym;
+    dy *= dySym;
+
+    if (dx >= dy) {
+        di = 2*dy - dx;
+        while (x0 != x1) {
+            oled_putPixel(x0, y0, color);
+            x0 += dxSym;
+            if (di < 0) {
+                di += 2*dy;
+            }
+            else {
+                di += 2*dy - 2*dx;
+                y0 += dySym;
+            }
+        }
+    }
+    else {
+        di = 2*dx - dy;
+        while (y0 != y1) {
+            oled_putPixel(x0, y0, color);
+            y0 += dySym;
+            if (di < 0) {
+                di += 2*dx;
+            }
+            else {
+                di += 2*dx - 2*dy;
+                x0 += dxSym;
+            }
+        }
+    }
+    oled_putPixel(x0, y0, color);
+}
+
+static void refRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
+                    oled_color_t color)
+{
+    refHLine(x0, y0, x1, color);
+    refHLine(x0, y1, x1, color);
+    refVLine(x0, y0, y1, color);
+    refVLine(x1, y0, y1, color);
+}
+
+static void refFillRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1,
+                        oled_color_t color)
+{
+    uint8_t y;
+
+    for (y = y0; y <= y1; y++) {
+        refHLine(x0, y, x1, color);
+    }
+}
+
+static void refPutString(uint8_t x, uint8_t y, const char *str,
+                         oled_color_t fg, oled_color_t bg)
+{
+    uint8_t ch, i, j;
+
+    for (; *str != '\0'; str++, x += FONT5X7_WIDTH) {
+        if (x >= OLED_DISPLAY_WIDTH - 8 || y >= OLED_DISPLAY_HEIGHT - 8) {
+            return;
+        }
+        ch = (*str < 0x20 || *str > 0x7f) ? 0 : *str - 0x20;
+        for (i = 0; i < 8; i++) {
+            for (j = 0; j < FONT5X7_WIDTH; j++) {
+                oled_putPixel(x + j, y + i,
+                              (font5x7[ch][i] & (0x80 >> j)) ? fg : bg);
+            }
+        }
+    }
+}
+
+static void refSceneText(void)
+{
+    refFillRect(0, 0, 95, 63, OLED_COLOR_BLACK);
+    refPutString(0, 0, "Hello OLED", OLED_COLOR_WHITE, OLED_COLOR_BLACK);
+    refPutString(3, 13, "y=13 !#$%&", OLED_COLOR_WHITE, OLED_COLOR_BLACK);
+    refPutString(10, 30, "inverse", OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+    refPutString(0, 55, "~{|}0123456789", OLED_COLOR_WHITE,
+                 OLED_COLOR_BLACK);
+}
+
+static void refSceneShapes(void)
+{
+    refFillRect(0, 0, 95, 63, OLED_COLOR_BLACK);
+    refRect(0, 0, 95, 63, OLED_COLOR_WHITE);
+    refFillRect(5, 3, 30, 20, OLED_COLOR_WHITE);
+    refFillRect(10, 7, 20, 11, OLED_COLOR_BLACK);
+    refLine(40, 5, 90, 30, OLED_COLOR_WHITE);
+    refLine(90, 5, 80, 60, OLED_COLOR_WHITE);
+    refLine(35, 60, 60, 40, OLED_COLOR_WHITE);
+    oled_circle(25, 42, 15, OLED_COLOR_WHITE);
+    oled_putPixel(94, 62, OLED_COLOR_WHITE);
+}
+
+static void refSceneDashboard(void)
+{
+    refFillRect(0, 0, 95, 63, OLED_COLOR_WHITE);
+    refRect(0, 0, 95, 63, OLED_COLOR_BLACK);
+    refLine(0, 12, 95, 12, OLED_COLOR_BLACK);
+    refPutString(4, 3, "Dashboard", OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+    refPutString(4, 16, "Temp 231", OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+    refPutString(4, 26, "Lux  481", OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+    refFillRect(4, 48, 60, 56, OLED_COLOR_BLACK);
+    oled_circle(80, 30, 8, OLED_COLOR_BLACK);
+}
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(uint32_t n)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % n;
+}
+
+/*
+ * oled_blit against a per-pixel model of the display: random bitmaps up
+ * to 100x64 at random, partly clipped positions with random raster
+ * operations, drawn over the result of the previous case. Returns the
+ * number of failed cases.
+ */
+static int checkBlit(void)
+{
+    static uint8_t model[OLED_DISPLAY_HEIGHT][OLED_DISPLAY_WIDTH];
+    static uint8_t bitmap[8 * 100];
+    int16_t bx, by;
+    uint8_t w, h, src;
+    oled_rop_t rop;
+    int t, x, y, px, py, diff;
+    int failed = 0;
+
+    oled_clearScreen(OLED_COLOR_BLACK);
+    oled_flush();
+    memset(model, 0, sizeof(model));
+
+    for (t = 0; t < BLIT_CASES; t++) {
+        w = 1 + rnd(100);
+        h = 1 + rnd(64);
+        bx = (int16_t)rnd(140) - 40;
+        by = (int16_t)rnd(100) - 30;
+        rop = (oled_rop_t)rnd(4);
+        for (x = 0; x < sizeof(bitmap); x++) {
+            bitmap[x] = rnd(256);
+        }
+
+        oled_blit(bx, by, w, h, bitmap, rop);
+        oled_flush();
+
+        for (y = 0; y < h; y++) {
+            for (x = 0; x < w; x++) {
+                px = bx + x;
+                py = by + y;
+                if (px < 0 || py < 0 || px >= OLED_DISPLAY_WIDTH
+                        || py >= OLED_DISPLAY_HEIGHT) {
+                    continue;
+                }
+                src = (bitmap[(y >> 3)*w + x] >> (y & 7)) & 1;
+                switch (rop) {
+                case OLED_ROP_COPY: model[py][px] = src;  break;
+                case OLED_ROP_OR:   model[py][px] |= src; break;
+                case OLED_ROP_AND:  model[py][px] &= src; break;
+                case OLED_ROP_XOR:  model[py][px] ^= src; break;
+                }
+            }
+        }
+
+        diff = 0;
+        for (y = 0; y < OLED_DISPLAY_HEIGHT; y++) {
+            for (x = 0; x < OLED_DISPLAY_WIDTH; x++) {
+                if (emu_getPixel(x, y) != model[y][x]) {
+                    /* continue from what the display shows */
+                    model[y][x] = emu_getPixel(x, y);
+                    diff++;
+                }
+            }
+        }
+        if (diff != 0) {
+            if (failed == 0) {
+                printf("  blit %d: %ux%u at %d,%d rop %d, %d pixels differ\n",
+                       t, w, h, bx, by, rop, diff);
+            }
+            failed++;
+        }
+    }
+
+    return failed;
+}
+
+static const scene_t scenes[] = {
+    {"text", sceneText},
+    {"shapes", sceneShapes},
+    {"dashboard", sceneDashboard},
+    {"update", sceneUpdate},
+    {"readout", sceneReadout},
+    {"icons", sceneIcons},
+    {"clear", sceneClear},
+    {"ref-text", refSceneText, "text"},
+    {"ref-shapes", refSceneShapes, "shapes"},
+    {"ref-dash", refSceneDashboard, "dashboard"},
+    {"chart", sceneChart},
+};
+
+static const char *modes[] = {"immediate", "retained", "double"};
+
+#define NUM_SCENES  (sizeof(scenes) / sizeof(scenes[0]))
+#define NUM_MODES   (sizeof(modes) / sizeof(modes[0]))
+
+int main(int argc, char **argv)
+{
+    char path[256];
+    emu_stats_t st;
+    int update = (argc > 2 && strcmp(argv[2], "--update") == 0);
+    int failed = 0;
+    int mode, i, diff;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <golden dir> [--update]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%-10s %-10s %8s %8s %8s\n", "scene", "mode", "cmd", "data",
+           "CS");
+
+    for (mode = 0; mode < NUM_MODES; mode++) {
+        emu_reset();
+        oled_init();
+        if (mode == 0) {
+            emu_getStats(&st);
+            printf("%-10s %-10s %8u %8u %8u\n", "init", "", st.cmdBytes,
+                   st.dataBytes, st.transfers);
+        }
+        if (mode == 1) {
+            oled_setRetained(TRUE);
+        }
+        if (mode == 2) {
+            oled_setDoubleBuffered(TRUE);
+        }
+
+        diff = checkBlit();
+        printf("%-10s %-10s %8u cases %10s\n", "blit", modes[mode],
+               BLIT_CASES, diff == 0 ? "ok" : "FAIL");
+        if (diff != 0) {
+            printf("  %d cases differ from the model\n", diff);
+            failed++;
+        }
+
+        for (i = 0; i < NUM_SCENES; i++) {
+            emu_clearStats();
+            scenes[i].draw();
+            oled_flush();
+            emu_getStats(&st);
+
+            snprintf(path, sizeof(path), "%s/%s.pbm", argv[1],
+                     scenes[i].golden ? scenes[i].golden : scenes[i].name);
+
+            if (update && mode == 0 && scenes[i].golden == NULL) {
+                emu_writePbm(path);
+                diff = 0;
+            }
+            else {
+                diff = emu_comparePbm(path);
+            }
+
+            printf("%-10s %-10s %8u %8u %8u  %s\n", scenes[i].name,
+                   modes[mode], st.cmdBytes, st.dataBytes, st.transfers,
+                   diff == 0 ? "ok" : "FAIL");
+            if (diff != 0) {
+                snprintf(path, sizeof(path), "%s_%s.pbm", scenes[i].name,
+                         modes[mode]);
+                emu_writePbm(path);
+                printf("  %d pixels differ, output written to %s\n", diff,
+                       path);
+                failed++;
+            }
+        }
+
+        oled_setDoubleBuffered(FALSE);
+        oled_setRetained(FALSE);
+    }
+
+    return failed ? 1 : 0;
+}
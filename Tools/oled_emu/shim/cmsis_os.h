@@ -0,0 +1,68 @@
+/*****************************************************************************
+ *   cmsis_os.h:  Host replacement for the parts of CMSIS-RTOS used by the
+ *                display driver, implemented with POSIX threads
+ *
+******************************************************************************/
+#ifndef _CMSIS_OS_H
+#define _CMSIS_OS_H
+
+#include <stdint.h>
+
+#define osWaitForever     0xFFFFFFFF
+
+typedef enum {
+  osPriorityIdle          = -3,
+  osPriorityLow           = -2,
+  osPriorityBelowNormal   = -1,
+  osPriorityNormal        =  0,
+  osPriorityAboveNormal   = +1,
+  osPriorityHigh          = +2,
+  osPriorityRealtime      = +3
+} osPriority;
+
+typedef enum {
+  osOK                    =    0,
+  osEventSignal           = 0x08,
+  osEventTimeout          = 0x40,
+  osErrorResource         = 0x81
+} osStatus;
+
+typedef void (*os_pthread) (void const *argument);
+
+typedef struct os_thread_cb *osThreadId;
+typedef struct os_semaphore_cb *osSemaphoreId;
+
+typedef struct {
+  os_pthread pthread;
+} osThreadDef_t;
+
+typedef struct {
+  uint32_t dummy;
+} osSemaphoreDef_t;
+
+typedef struct {
+  osStatus status;
+  union {
+    uint32_t v;
+    int32_t signals;
+  } value;
+} osEvent;
+
+#define osThreadDef(name, priority, instances, stacksz) \
+const osThreadDef_t os_thread_def_##name = { (name) }
+#define osThread(name)  &os_thread_def_##name
+
+#define osSemaphoreDef(name) \
+const osSemaphoreDef_t os_semaphore_def_##name = { 0 }
+#define osSemaphore(name)  &os_semaphore_def_##name
+
+int32_t osKernelRunning (void);
+osThreadId osThreadCreate (const osThreadDef_t *thread_def, void *argument);
+osThreadId osThreadGetId (void);
+int32_t osSignalSet (osThreadId thread_id, int32_t signals);
+osEvent osSignalWait (int32_t signals, uint32_t millisec);
+osSemaphoreId osSemaphoreCreate (const osSemaphoreDef_t *semaphore_def, int32_t count);
+int32_t osSemaphoreWait (osSemaphoreId semaphore_id, uint32_t millisec);
+osStatus osSemaphoreRelease (osSemaphoreId semaphore_id);
+
+#endif /* end _CMSIS_OS_H */
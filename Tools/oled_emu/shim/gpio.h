@@ -0,0 +1,31 @@
+/*****************************************************************************
+ *   gpio.h:  Host replacement, pins are routed to the OLED emulator
+ *
+******************************************************************************/
+#ifndef __GPIO_H
+#define __GPIO_H
+
+#include <stdint.h>
+
+#define PORT0		0
+#define PORT1		1
+#define PORT2		2
+#define PORT3		3
+
+typedef struct
+{
+  uint32_t port;
+  uint32_t mask;
+} gpio_pin_t;
+
+#define GPIO_PIN(portNum, bitPosi)	((gpio_pin_t){ (portNum), 1UL << (bitPosi) })
+
+void EmuPinWrite( uint32_t port, uint32_t mask, uint32_t value );
+
+#define GPIOPinSet(pin)		EmuPinWrite( (pin).port, (pin).mask, 1 )
+#define GPIOPinClear(pin)	EmuPinWrite( (pin).port, (pin).mask, 0 )
+
+void GPIOSetDir( uint32_t portNum, uint32_t bitPosi, uint32_t dir );
+void GPIOSetValue( uint32_t portNum, uint32_t bitPosi, uint32_t bitVal );
+
+#endif /* end __GPIO_H */
@@ -0,0 +1,10 @@
+/*****************************************************************************
+ *   mcu_regs.h:  Host replacement, no peripheral registers on the host
+ *
+******************************************************************************/
+#ifndef __MCU_REGS_H
+#define __MCU_REGS_H
+
+#include <stdint.h>
+
+#endif /* end __MCU_REGS_H */